@@ -0,0 +1,332 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "broadphase.h"
+#include "game.h"
+#include "motion.h"
+#include "rng.h"
+#include "snapshot.h"
+#include "statehash.h"
+
+// Per-phase micro-benchmarks for the simulation hot paths. Every phase runs
+// on the same seeded benchmark scene at each density; each repetition is
+// timed on its own, with any state it consumes restored beforehand and off
+// the clock, and the median is reported per entity processed.
+
+#define DEFAULT_REPS 51
+#define EXPLOSION_CALLS 64
+
+typedef struct {
+    const char* name;
+    // Restores whatever run() consumes. Not timed.
+    void (*setup)(void);
+    void (*run)(void);
+    // Entities processed by one run().
+    int (*entities)(void);
+} Phase;
+
+static GameState pristine;
+static GameState work;
+static BroadPhase phaseBroadPhase;
+static RenderSnapshot snapshot;
+// The scene's enemies split by type, never modified after the split; the
+// motion phases run on a copy in motionEnemies.
+static EnemyPool enemiesOfType[ENEMY_BOSS + 1];
+static EnemyPool motionEnemies;
+static Arena scratchArena;
+static int* queryOut;
+static BroadPhaseScratch queryScratch;
+static volatile int sink;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int cmp_asc_double(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    if (da < db) return -1;
+    if (da > db) return 1;
+    return 0;
+}
+
+static void setup_none(void) {
+}
+
+static void setup_work(void) {
+    gameCopy(&work, &pristine);
+}
+
+static void run_build_enemies(void) {
+    broadPhaseBuild(&phaseBroadPhase, work.enemies.x, work.enemies.y,
+                    work.enemies.width, work.enemies.height, work.enemies.count);
+}
+
+static void run_build_enemy_bullets(void) {
+    broadPhaseBuild(&phaseBroadPhase, work.enemyBullets.x, work.enemyBullets.y,
+                    work.enemyBullets.width, work.enemyBullets.height, work.enemyBullets.count);
+}
+
+static void run_build_powerups(void) {
+    broadPhaseBuild(&phaseBroadPhase, work.powerups.x, work.powerups.y,
+                    work.powerups.width, work.powerups.height, work.powerups.count);
+}
+
+static int count_enemies(void) { return work.enemies.count; }
+static int count_enemy_bullets(void) { return work.enemyBullets.count; }
+static int count_powerups(void) { return work.powerups.count; }
+static int count_bullets(void) { return work.bullets.count; }
+
+static void setup_bullet_queries(void) {
+    run_build_enemies();
+}
+
+static void run_bullet_queries(void) {
+    const BulletPool* b = &work.bullets;
+    int found = 0;
+    for (int i = 0; i < b->count; i++) {
+        found += broadPhaseQueryInto(&phaseBroadPhase, b->x[i], b->y[i],
+                                     b->x[i] + b->width[i], b->y[i] + b->height[i],
+                                     queryOut, &queryScratch);
+    }
+    sink = found;
+}
+
+static void run_handle_collisions(void) {
+    handleCollisions(&work);
+}
+
+static void copy_enemy(EnemyPool* dst, int k, const EnemyPool* src, int i) {
+    dst->x[k] = src->x[i];
+    dst->y[k] = src->y[i];
+    dst->prevX[k] = src->prevX[i];
+    dst->prevY[k] = src->prevY[i];
+    dst->width[k] = src->width[i];
+    dst->height[k] = src->height[i];
+    dst->speed[k] = src->speed[i];
+    dst->health[k] = src->health[i];
+    dst->type[k] = src->type[i];
+    dst->active[k] = src->active[i];
+    dst->bulletCooldown[k] = src->bulletCooldown[i];
+    dst->movementPattern[k] = src->movementPattern[i];
+    dst->score[k] = src->score[i];
+}
+
+static void restore_enemies(EnemyPool* dst, const EnemyPool* src) {
+    for (int i = 0; i < src->count; i++) {
+        copy_enemy(dst, i, src, i);
+    }
+    dst->count = src->count;
+}
+
+// Motion alone, and the whole enemy pass (timers, retargets, volleys into
+// the enemy bullet pool, vertical movement, settling, benchmark wraps) on
+// the work scene with only enemies of one type in it.
+#define ENEMY_TYPE_PHASES(suffix, type)                                         \
+    static void setup_motion_##suffix(void) {                                   \
+        restore_enemies(&motionEnemies, &enemiesOfType[type]);                  \
+    }                                                                           \
+    static void run_motion_##suffix(void) {                                     \
+        updateEnemyMotion(&motionEnemies, 0, motionEnemies.count, 1.0f / 60.0f, \
+                          320.0f);                                              \
+    }                                                                           \
+    static void setup_update_##suffix(void) {                                   \
+        gameCopy(&work, &pristine);                                             \
+        restore_enemies(&work.enemies, &enemiesOfType[type]);                   \
+    }                                                                           \
+    static void run_update_##suffix(void) {                                     \
+        updateEnemies(&work, 1.0f / 60.0f);                                     \
+    }                                                                           \
+    static int count_type_##suffix(void) { return enemiesOfType[type].count; }
+
+ENEMY_TYPE_PHASES(small, ENEMY_SMALL)
+ENEMY_TYPE_PHASES(medium, ENEMY_MEDIUM)
+ENEMY_TYPE_PHASES(large, ENEMY_LARGE)
+ENEMY_TYPE_PHASES(boss, ENEMY_BOSS)
+
+static void run_create_explosion(void) {
+    for (int k = 0; k < EXPLOSION_CALLS; k++) {
+        createExplosion(&work, (float)(k * 7 % 480), (float)(k * 13 % 320), 24.0f);
+    }
+}
+
+static int count_explosion_calls(void) {
+    return EXPLOSION_CALLS;
+}
+
+static void run_snapshot(void) {
+    snapshotCapture(&snapshot, &work, 0);
+}
+
+static int count_snapshot(void) {
+    return work.bullets.count + work.enemyBullets.count + work.enemies.count +
+           work.powerups.count + work.explosions.count;
+}
+
+static void run_state_hash(void) {
+    sink = (int)stateHash(&work);
+}
+
+static const Phase phases[] = {
+    { "build.enemies",         setup_none,           run_build_enemies,       count_enemies },
+    { "build.enemyBullets",    setup_none,           run_build_enemy_bullets, count_enemy_bullets },
+    { "build.powerups",        setup_none,           run_build_powerups,      count_powerups },
+    { "collide.bulletQueries", setup_bullet_queries, run_bullet_queries,      count_bullets },
+    { "collide.handle",        setup_work,           run_handle_collisions,   count_bullets },
+    { "enemy.motion.small",    setup_motion_small,   run_motion_small,        count_type_small },
+    { "enemy.motion.medium",   setup_motion_medium,  run_motion_medium,       count_type_medium },
+    { "enemy.motion.large",    setup_motion_large,   run_motion_large,        count_type_large },
+    { "enemy.motion.boss",     setup_motion_boss,    run_motion_boss,         count_type_boss },
+    { "enemy.update.small",    setup_update_small,   run_update_small,        count_type_small },
+    { "enemy.update.medium",   setup_update_medium,  run_update_medium,       count_type_medium },
+    { "enemy.update.large",    setup_update_large,   run_update_large,        count_type_large },
+    { "enemy.update.boss",     setup_update_boss,    run_update_boss,         count_type_boss },
+    { "explosion.create",      setup_work,           run_create_explosion,    count_explosion_calls },
+    { "render.snapshot",       setup_none,           run_snapshot,            count_snapshot },
+    { "state.hash",            setup_none,           run_state_hash,          count_snapshot },
+};
+
+static void split_enemies_by_type(void) {
+    for (int t = ENEMY_SMALL; t <= ENEMY_BOSS; t++) {
+        enemiesOfType[t].count = 0;
+    }
+
+    const EnemyPool* e = &pristine.enemies;
+    for (int i = 0; i < e->count; i++) {
+        EnemyPool* pool = &enemiesOfType[e->type[i]];
+        copy_enemy(pool, pool->count++, e, i);
+    }
+}
+
+static void carve_scratch(const GameCapacities* capacities, Arena* arena) {
+    for (int t = ENEMY_SMALL; t <= ENEMY_BOSS; t++) {
+        enemyPoolAllocate(&enemiesOfType[t], capacities->enemies, arena);
+    }
+    enemyPoolAllocate(&motionEnemies, capacities->enemies, arena);
+    queryOut = arenaAlloc(arena, sizeof(int) * (size_t)capacities->enemies);
+}
+
+// Both scenes and every per-phase buffer sized for capacities.
+static void allocate(const GameCapacities* capacities) {
+    gameAllocate(&pristine, capacities);
+    gameAllocate(&work, capacities);
+
+    Arena measure = { 0 };
+    carve_scratch(capacities, &measure);
+    arenaInit(&scratchArena, measure.used);
+    carve_scratch(capacities, &scratchArena);
+    broadPhaseScratchReserve(&queryScratch, capacities->enemies);
+}
+
+static void prepare_scene(int density, uint32_t seed, BroadPhaseKind broadPhase) {
+    rng_seed(seed);
+    initGame(&pristine);
+    pristine.broadPhase = broadPhase;
+    prepareBenchmarkScene(&pristine, density);
+    gameCopy(&work, &pristine);
+    phaseBroadPhase.kind = broadPhase;
+    split_enemies_by_type();
+}
+
+static void run_phase(const Phase* phase, int density, int reps, double* samples) {
+    int entities = phase->entities();
+    if (entities <= 0) {
+        printf("%-22s %7d %9d %12s %12s %12s\n", phase->name, density, 0, "-", "-", "-");
+        return;
+    }
+
+    // One untimed pass so first-touch allocation stays out of the samples.
+    phase->setup();
+    phase->run();
+
+    for (int r = 0; r < reps; r++) {
+        phase->setup();
+        double start = now_seconds();
+        phase->run();
+        samples[r] = now_seconds() - start;
+    }
+    qsort(samples, (size_t)reps, sizeof(double), cmp_asc_double);
+
+    double median = samples[reps / 2];
+    printf("%-22s %7d %9d %12.2f %12.2f %12.2f\n", phase->name, density, entities,
+           median * 1e6, samples[0] * 1e6, median * 1e9 / entities);
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [--density N[,N...]] [--reps N] [--seed N] [--broadphase grid|sap|bvh]\n"
+           "          [--phase NAME]\n"
+           "          [--capacity bullets=N,enemies=N,enemyBullets=N,powerups=N,explosions=N]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int densities[16] = { 25, 50, 100 };
+    int densityCount = 3;
+    int reps = DEFAULT_REPS;
+    uint32_t seed = 12345u;
+    BroadPhaseKind broadPhase = BROADPHASE_GRID;
+    const char* onlyPhase = NULL;
+    GameCapacities capacities;
+    gameCapacitiesDefault(&capacities);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
+            densityCount = 0;
+            for (char* tok = strtok(argv[++i], ","); tok && densityCount < 16; tok = strtok(NULL, ",")) {
+                int d = atoi(tok);
+                densities[densityCount++] = d < 0 ? 0 : (d > 100 ? 100 : d);
+            }
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc) {
+            if (!broadPhaseFromName(argv[++i], &broadPhase)) {
+                printf("Unknown broad phase: %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--phase") == 0 && i + 1 < argc) {
+            onlyPhase = argv[++i];
+        } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            if (!gameCapacitiesParse(&capacities, argv[++i])) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    double* samples = malloc(sizeof(double) * (size_t)reps);
+    if (!samples) {
+        printf("Failed to allocate %d samples\n", reps);
+        return 1;
+    }
+
+    allocate(&capacities);
+
+    printf("[Microbench] reps=%d, seed=%u, broadphase=%s\n", reps, seed, broadPhaseName(broadPhase));
+    printf("%-22s %7s %9s %12s %12s %12s\n", "phase", "density", "entities", "median us", "min us", "ns/entity");
+
+    for (int d = 0; d < densityCount; d++) {
+        prepare_scene(densities[d], seed, broadPhase);
+        for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); p++) {
+            if (onlyPhase && strcmp(onlyPhase, phases[p].name) != 0) {
+                continue;
+            }
+            run_phase(&phases[p], densities[d], reps, samples);
+        }
+    }
+
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,337 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "autopilot.h"
+#include "game.h"
+#include "jobs.h"
+#include "replay.h"
+#include "report.h"
+#include "rng.h"
+#include "savestate.h"
+#include "soak.h"
+#include "statehash.h"
+#include "trace.h"
+
+// Simulation-only benchmark: builds the --benchmark scene and runs fixed-dt
+// updateGame ticks with no window, GL context or swap in the measurement.
+// With --replay it plays a recorded session instead, from its own seed and
+// for its own length, and checks that it ends in the recorded state.
+// --load-state starts from a saved scene instead; --save-state saves the
+// scene the run ends in, e.g. to capture a late moment of a replay.
+// --capacity resizes the pools; --density is a percentage of them.
+// --soak plays MINUTES of game time of real levels with the autopilot,
+// starting a new game whenever one ends, and reports per-level tick cost.
+// --verify-broadphase runs every collision query through all backends and a
+// brute-force scan of the boxes, and fails the run if any hit set differs.
+
+static GameState gameState;
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [--ticks N] [--warmup N] [--density 0-100] [--seed N]\n"
+           "          [--broadphase grid|sap|bvh] [--verify-broadphase] [--threads N (0 = all cores)]\n"
+           "          [--trace FILE.json] [--report json|csv] [--report-file PATH]\n"
+           "          [--baseline FILE.json] [--tolerance PCT]\n"
+           "          [--hash-log FILE | --hash-check FILE] [--replay FILE]\n"
+           "          [--load-state FILE] [--save-state FILE]\n"
+           "          [--capacity bullets=N,enemies=N,enemyBullets=N,powerups=N,explosions=N]\n"
+           "          [--soak MINUTES] [--soak-log FILE.csv]\n", prog);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+    int optTicks = 3000;
+    int optWarmup = 120;
+    int optDensity = 100;
+    uint32_t optSeed = 12345u;
+    BroadPhaseKind optBroadPhase = BROADPHASE_GRID;
+    bool optVerifyBroadPhase = false;
+    int optThreads = 1;
+    const char* optTrace = NULL;
+    ReportFormat optReport = REPORT_NONE;
+    const char* optReportFile = NULL;
+    const char* optBaseline = NULL;
+    double optTolerance = 10.0;
+    const char* optHashFile = NULL;
+    bool optHashCheck = false;
+    const char* optReplay = NULL;
+    const char* optLoadState = NULL;
+    const char* optSaveState = NULL;
+    GameCapacities optCapacities;
+    gameCapacitiesDefault(&optCapacities);
+    double optSoak = 0.0;
+    int optSoakTicks = 0;
+    const char* optSoakLog = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            optTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            optWarmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
+            optDensity = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            optSeed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc) {
+            if (!broadPhaseFromName(argv[++i], &optBroadPhase)) {
+                printf("Unknown broad phase: %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--verify-broadphase") == 0) {
+            optVerifyBroadPhase = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            optThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            optTrace = argv[++i];
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            if (!reportFormatFromName(argv[++i], &optReport)) {
+                printf("Unknown report format: %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--report-file") == 0 && i + 1 < argc) {
+            optReportFile = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            optBaseline = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            optTolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            optHashFile = argv[++i];
+            optHashCheck = false;
+        } else if (strcmp(argv[i], "--hash-check") == 0 && i + 1 < argc) {
+            optHashFile = argv[++i];
+            optHashCheck = true;
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            optReplay = argv[++i];
+        } else if (strcmp(argv[i], "--load-state") == 0 && i + 1 < argc) {
+            optLoadState = argv[++i];
+        } else if (strcmp(argv[i], "--save-state") == 0 && i + 1 < argc) {
+            optSaveState = argv[++i];
+        } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            if (!gameCapacitiesParse(&optCapacities, argv[++i])) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            if (!soakParseMinutes(argv[++i], &optSoak, &optSoakTicks)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--soak-log") == 0 && i + 1 < argc) {
+            optSoakLog = argv[++i];
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optReplay && optLoadState) {
+        printf("--replay starts from a new game and cannot be combined with --load-state\n");
+        return 1;
+    }
+    if (optSoak > 0.0 && (optReplay || optLoadState)) {
+        printf("--soak plays new games and cannot be combined with --replay or --load-state\n");
+        return 1;
+    }
+
+    static Replay replay;
+    if (optReplay) {
+        if (!replayLoad(&replay, optReplay)) {
+            return 1;
+        }
+        if (replay.ticks == 0) {
+            printf("Replay %s has no ticks\n", optReplay);
+            return 1;
+        }
+        optSeed = replay.seed;
+        optTicks = (int)replay.ticks;
+        optWarmup = 0;
+    }
+    if (optSoak > 0.0) {
+        optTicks = optSoakTicks;
+        optWarmup = 0;
+    }
+
+    if (optTicks < 1) optTicks = 1;
+    if (optWarmup < 0) optWarmup = 0;
+    if (optDensity < 0) optDensity = 0;
+    if (optDensity > 100) optDensity = 100;
+    if (optThreads <= 0) optThreads = jobsHardwareThreads();
+    jobsInit(optThreads);
+
+    // A report on stdout must be the only thing there; the human-readable
+    // summary, and what the hash log, replay and trace have to say, move to
+    // stderr.
+    FILE* text = (optReport != REPORT_NONE && !optReportFile) ? stderr : stdout;
+
+    rng_seed(optSeed);
+    gameAllocate(&gameState, &optCapacities);
+    initGame(&gameState);
+    gameState.broadPhase = optBroadPhase;
+    gameState.verifyBroadPhase = optVerifyBroadPhase;
+    if (optLoadState) {
+        if (!loadState(&gameState, optLoadState)) {
+            return 1;
+        }
+        optSeed = rng_current_seed();
+    } else if (!optReplay && optSoak <= 0.0) {
+        prepareBenchmarkScene(&gameState, optDensity);
+    }
+
+    // Warmup ticks are logged too, so tick numbers count from the scene.
+    StateHashLog hashLog = { 0 };
+    if (optHashFile && !stateHashLogOpen(&hashLog, optHashFile, optHashCheck, optSeed, text)) {
+        return 1;
+    }
+
+    const float fixedDt = 1.0f / 60.0f;
+    double* tickDurations = malloc(sizeof(double) * (size_t)optTicks);
+    if (!tickDurations) {
+        printf("Failed to allocate %d tick timings\n", optTicks);
+        return 1;
+    }
+
+    if (optLoadState) {
+        fprintf(text, "[Simbench] state=%s, ticks=%d, warmup=%d, broadphase=%s, threads=%d\n",
+                optLoadState, optTicks, optWarmup, broadPhaseName(optBroadPhase), jobsThreadCount());
+    } else if (optSoak > 0.0) {
+        fprintf(text, "[Simbench] soak=%.1f min, ticks=%d, seed=%u, broadphase=%s, threads=%d\n",
+                optSoak, optTicks, optSeed, broadPhaseName(optBroadPhase), jobsThreadCount());
+    } else if (optReplay) {
+        fprintf(text, "[Simbench] replay=%s, ticks=%d, seed=%u, broadphase=%s, threads=%d\n",
+                optReplay, optTicks, optSeed, broadPhaseName(optBroadPhase), jobsThreadCount());
+    } else {
+        fprintf(text, "[Simbench] density=%d, ticks=%d, warmup=%d, seed=%u, broadphase=%s, threads=%d\n",
+                optDensity, optTicks, optWarmup, optSeed, broadPhaseName(optBroadPhase), jobsThreadCount());
+    }
+
+    for (int t = 0; t < optWarmup; t++) {
+        updateGame(&gameState, fixedDt);
+        stateHashLogTick(&hashLog, &gameState);
+    }
+
+    TRACE_THREAD_NAME("main");
+    if (optTrace && !traceStart()) {
+        fprintf(text, "Tracing is not compiled in (rebuild with TRACE=1); ignoring --trace\n");
+        optTrace = NULL;
+    }
+
+    SoakLog soak = { 0 };
+    if (optSoak > 0.0 && !soakOpen(&soak, optSoakLog, text)) {
+        return 1;
+    }
+
+    double start = now_seconds();
+    for (int t = 0; t < optTicks; t++) {
+        TickInput input;
+        if (optReplay && replayNext(&replay, &input)) {
+            applyTickInput(&gameState, &input);
+        } else if (optSoak > 0.0) {
+            autopilotInput(&gameState, &input);
+            applyTickInput(&gameState, &input);
+        }
+        double tickStart = now_seconds();
+        updateGame(&gameState, fixedDt);
+        tickDurations[t] = now_seconds() - tickStart;
+        stateHashLogTick(&hashLog, &gameState);
+
+        if (optSoak > 0.0) {
+            soakTick(&soak, &gameState, tickDurations[t]);
+            if (gameState.gameOver) {
+                soakGameOver(&soak, &gameState);
+                int mismatches = gameState.broadPhaseMismatches;
+                initGame(&gameState);
+                gameState.broadPhase = optBroadPhase;
+                gameState.verifyBroadPhase = optVerifyBroadPhase;
+                gameState.broadPhaseMismatches = mismatches;
+            }
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    if (optTrace) {
+        traceStop();
+        traceWrite(optTrace, text);
+    }
+
+    BenchReport report = { 0 };
+    report.tool = optReplay ? "simbench --replay" : (optSoak > 0.0 ? "simbench --soak" : "simbench");
+    report.density = (optReplay || optLoadState || optSoak > 0.0) ? 0 : optDensity;
+    report.threads = jobsThreadCount();
+    report.seed = optSeed;
+    report.broadPhase = optBroadPhase;
+    report.capacities = optCapacities;
+    report.measuredSeconds = elapsed;
+    report.ticksPerSecond = (elapsed > 0.0) ? optTicks / elapsed : 0.0;
+    latencyStatsCompute(&report.ticks, tickDurations, optTicks);
+    report.bullets = gameState.bullets.count;
+    report.enemies = gameState.enemies.count;
+    report.enemyBullets = gameState.enemyBullets.count;
+    report.powerups = gameState.powerups.count;
+    report.explosions = gameState.explosions.count;
+    report.score = gameState.player.score;
+
+    fprintf(text, "\nSimulation benchmark results\n");
+    fprintf(text, "Ticks: %d\n", optTicks);
+    fprintf(text, "Measured time: %.3f s\n", elapsed);
+    fprintf(text, "Ticks/s: %.1f\n", report.ticksPerSecond);
+    fprintf(text, "Tick latency (ms): p50 %.3f, p90 %.3f, p99 %.3f, p99.9 %.3f, max %.3f\n",
+            report.ticks.p50, report.ticks.p90, report.ticks.p99, report.ticks.p999, report.ticks.max);
+    fprintf(text, "Final state: bullets=%d enemies=%d enemyBullets=%d powerups=%d explosions=%d score=%d\n",
+            report.bullets, report.enemies, report.enemyBullets, report.powerups, report.explosions,
+            report.score);
+    fprintf(text, "State hash: %016" PRIx64 "\n", stateHash(&gameState));
+    if (optVerifyBroadPhase) {
+        fprintf(text, "Broad-phase mismatches (%s): %d\n",
+                broadPhaseName(optBroadPhase), gameState.broadPhaseMismatches);
+    }
+
+    int status = 0;
+    if (optSoak > 0.0) {
+        soakPrintSummary(&soak, text);
+        if (!soakClose(&soak)) {
+            status = 1;
+        }
+    }
+    if (optSaveState && !saveState(&gameState, optSaveState)) {
+        status = 1;
+    }
+    if (optReplay) {
+        int replayStatus = replayCheck(&replay, stateHash(&gameState), text);
+        if (replayStatus != 0) {
+            status = replayStatus;
+        }
+        replayFree(&replay);
+    }
+    if (optVerifyBroadPhase && gameState.broadPhaseMismatches > 0) {
+        status = 2;
+    }
+    if (!stateHashLogClose(&hashLog)) {
+        status = 2;
+    }
+    if (optReport != REPORT_NONE && !reportWrite(&report, optReport, optReportFile)) {
+        status = 1;
+    }
+    if (optBaseline) {
+        int regressions = reportCompareBaseline(&report, optBaseline, optTolerance, text);
+        if (regressions != 0) {
+            status = (regressions < 0) ? 1 : 2;
+        }
+    }
+
+    free(tickDurations);
+    jobsShutdown();
+    return status;
+}
@@ -0,0 +1,47 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator over one block of memory. Everything carved from an arena
+// is released together by arenaFree; there is no per-allocation free.
+//
+// An arena with no block only measures: arenaAlloc advances used and
+// returns NULL. Running the same sequence of allocations through a
+// measuring arena first gives the exact size to pass to arenaInit.
+typedef struct {
+    unsigned char* base;
+    size_t size;
+    size_t used;
+} Arena;
+
+// Allocations are aligned to a cache line, so columns carved one after the
+// other never share one.
+#define ARENA_ALIGN 64
+
+// Allocates the block, zeroed. Exits if the allocation fails.
+void arenaInit(Arena* arena, size_t size);
+// size bytes aligned to ARENA_ALIGN. Exits when the block is exhausted.
+void* arenaAlloc(Arena* arena, size_t size);
+void arenaFree(Arena* arena);
+
+// Linear allocator for memory that lives for one frame (one tick). frameReset
+// releases everything handed out since the previous reset at once. A frame
+// that outgrows the block is served from overflow allocations, and the next
+// reset replaces the block with one big enough for that frame, so once the
+// scene stops growing every frame is a single block and no malloc.
+typedef struct {
+    Arena block;
+    // Overflow allocations of the current frame, linked through their first
+    // bytes.
+    void* overflow;
+    // Bytes handed out this frame, alignment included.
+    size_t frameBytes;
+    size_t peakBytes;
+} FrameArena;
+
+// size bytes aligned to ARENA_ALIGN, valid until the next frameReset.
+void* frameAlloc(FrameArena* frame, size_t size);
+void frameReset(FrameArena* frame);
+
+#endif
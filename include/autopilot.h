@@ -0,0 +1,16 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "game.h"
+#include "replay.h"
+
+// Built-in player for soak runs. It holds the left of the screen, lines up
+// with the nearest enemy (the boss once it is out), fires every tick and
+// steps out of the way of enemy bullets and enemies heading for it.
+//
+// The input is a pure function of gameState: it draws nothing from the RNG
+// and keeps no state of its own, so a run with the autopilot is exactly as
+// deterministic as a replay, and can be recorded like one.
+void autopilotInput(const GameState* gameState, TickInput* input);
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <stdbool.h>
+
+#include "grid.h"
+
+// Broad-phase structures that handleCollisions can be switched between at
+// runtime. Every backend answers the same query (which entities' boxes
+// strictly overlap this box) with the same answer, so the choice only affects
+// speed.
+typedef enum {
+    BROADPHASE_GRID,
+    BROADPHASE_SAP,
+    BROADPHASE_BVH,
+    BROADPHASE_KIND_COUNT
+} BroadPhaseKind;
+
+// Sort-and-sweep on x. order holds entity indices sorted by minX and is kept
+// between builds so that re-sorting a slowly moving scene is nearly linear.
+typedef struct {
+    int* order;
+    float* minX;
+    float* minY;
+    float* maxX;
+    float* maxY;
+    int count;
+    float maxWidth;
+} SweepState;
+
+// Leaf when count > 0 (items[start, start + count)); otherwise the children
+// are nodes child and child + 1.
+typedef struct {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+    int child;
+    int start;
+    int count;
+} BvhNode;
+
+// Bounding volume hierarchy. Rebuilt top-down when the entity count changes
+// and refitted in place otherwise, with a periodic rebuild to bound how loose
+// the refitted boxes get.
+typedef struct {
+    BvhNode* nodes;
+    int* items;
+    int nodeCount;
+    int builtCount;
+    int refits;
+} BvhState;
+
+// Query scratch owned by one querying thread. The grid marks every entity a
+// multi-cell query reports with the query's epoch, so an entity met again in
+// the next cell is skipped with one compare, and since every query takes a
+// new epoch the stamps never need clearing.
+typedef struct {
+    int* offsets;
+    unsigned* stamps;
+    unsigned epoch;
+    int capacity;
+} BroadPhaseScratch;
+
+typedef struct {
+    BroadPhaseKind kind;
+
+    // Box snapshot taken by the last broadPhaseBuild, indexed by entity.
+    float* minX;
+    float* minY;
+    float* maxX;
+    float* maxY;
+    int count;
+    int capacity;
+
+    // Output of broadPhaseQuery: unique entity indices in ascending order.
+    int* results;
+
+    // Scratch for broadPhaseQuery and broadPhaseCrossCheck, and temporary
+    // storage for the sweep sort.
+    BroadPhaseScratch queryScratch;
+    int* sortTemp;
+    int* expected;
+
+    CollisionGrid grid;
+    SweepState sweep;
+    BvhState bvh;
+} BroadPhase;
+
+const char* broadPhaseName(BroadPhaseKind kind);
+bool broadPhaseFromName(const char* name, BroadPhaseKind* kind);
+
+// Snapshots the first n boxes and builds the structure selected by kind.
+void broadPhaseBuild(BroadPhase* bp, const float* x, const float* y,
+                     const float* width, const float* height, int n);
+
+// Writes to bp->results every entity whose snapshot box strictly overlaps the
+// given box, ascending and without duplicates. Returns how many were written.
+int broadPhaseQuery(BroadPhase* bp, float minX, float minY, float maxX, float maxY);
+
+// Grows scratch for queries against up to count entities.
+void broadPhaseScratchReserve(BroadPhaseScratch* scratch, int count);
+
+// Same query without touching bp, so several threads can run it at once,
+// each with its own scratch. out must hold bp->count entries and scratch be
+// reserved for as many.
+int broadPhaseQueryInto(const BroadPhase* bp, float minX, float minY, float maxX, float maxY,
+                        int* out, BroadPhaseScratch* scratch);
+
+// Builds every other backend on the current snapshot and runs the first n
+// query boxes through all of them, the active one included, and through a
+// brute-force scan of the snapshot. Returns how many queries any backend
+// answered differently from the scan.
+int broadPhaseCrossCheck(BroadPhase* bp, const float* x, const float* y,
+                         const float* width, const float* height, int n);
+
+#endif
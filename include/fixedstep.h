@@ -0,0 +1,35 @@
+#ifndef FIXEDSTEP_H
+#define FIXEDSTEP_H
+
+// Fixed-tick clock shared by the serial loop, the benchmark loop and the
+// pipelined simulation thread. Wall time accumulates and is paid out in
+// whole ticks; the remainder is how far the renderer is between the last
+// tick and the next one.
+//
+// A frame that falls behind by more than maxSubsteps ticks runs only
+// maxSubsteps of them and drops the rest, so the game slows down (time
+// dilation) instead of spending ever longer catching up.
+
+#define DEFAULT_MAX_SUBSTEPS 5
+
+typedef struct {
+    double tickSeconds;
+    // 0 runs every tick that is due, however many.
+    int maxSubsteps;
+    double lastTime;
+    double accumulator;
+    // Wall time dropped because the ticks could not keep up.
+    double droppedSeconds;
+} FixedStep;
+
+// now is in seconds, from whatever clock the caller passes to
+// fixedStepAdvance as well.
+void fixedStepInit(FixedStep* step, double tickSeconds, int maxSubsteps, double now);
+
+// Adds the time since the last call and returns how many ticks to run now.
+int fixedStepAdvance(FixedStep* step, double now);
+
+// How far the time not yet simulated is into the next tick, in [0, 1).
+float fixedStepAlpha(const FixedStep* step);
+
+#endif
@@ -3,11 +3,19 @@
 
 #include <stdbool.h>
 
-#define MAX_BULLETS 2500
-#define MAX_ENEMIES 2500
-#define MAX_ENEMY_BULLETS 2500
-#define MAX_POWERUPS 2500
-#define MAX_EXPLOSIONS 1000
+#include "arena.h"
+#include "broadphase.h"
+
+// Pool capacities used unless --capacity asks for others.
+#define DEFAULT_MAX_BULLETS 2500
+#define DEFAULT_MAX_ENEMIES 2500
+#define DEFAULT_MAX_ENEMY_BULLETS 2500
+#define DEFAULT_MAX_POWERUPS 2500
+#define DEFAULT_MAX_EXPLOSIONS 1000
+
+// Playfield size in world units.
+#define SCREEN_WIDTH 480
+#define SCREEN_HEIGHT 320
 
 typedef enum {
     DIR_NONE,
@@ -36,6 +44,8 @@ typedef enum {
 
 typedef struct {
     float x, y;
+    // Position at the start of the last tick, for render interpolation.
+    float prevX, prevY;
     float width, height;
     Direction direction;
     int lives;
@@ -46,41 +56,96 @@ typedef struct {
     float bulletCooldown;
 } Player;
 
+// Entity pools are stored as structure-of-arrays: every field is its own
+// column so the movement, collision and render passes only stream the fields
+// they actually read. The columns are sized at startup (see GameCapacities)
+// and carved out of the GameState's arena by gameAllocate.
+//
+// Live entities are kept packed in [0, count): spawning appends, and dead
+// entries are swap-removed at the end of each update or collision pass, so
+// every loop scales with the number of live entities rather than capacity.
+//
+// prevX/prevY hold where a moving entity was at the start of the last tick.
+// They only feed render interpolation, never the simulation, and are set to
+// the current position whenever an entity spawns or teleports.
 typedef struct {
-    float x, y;
-    float width, height;
-    float speed;
-    bool active;
-} Bullet;
+    float* x;
+    float* y;
+    float* prevX;
+    float* prevY;
+    float* width;
+    float* height;
+    float* speed;
+    bool* active;
+    int count;
+    int capacity;
+} BulletPool;
 
 typedef struct {
-    float x, y;
-    float width, height;
-    float speed;
-    int health;
-    EnemyType type;
-    bool active;
-    float bulletCooldown;
-    float movementPattern;  
-    int score;  
-} Enemy;
+    float* x;
+    float* y;
+    float* prevX;
+    float* prevY;
+    float* width;
+    float* height;
+    float* speed;
+    int* health;
+    EnemyType* type;
+    bool* active;
+    float* bulletCooldown;
+    float* movementPattern;
+    int* score;
+    int count;
+    int capacity;
+} EnemyPool;
 
 typedef struct {
-    float x, y;
-    float width, height;
-    PowerupType type;
-    bool active;
-    float speed;
-} Powerup;
+    float* x;
+    float* y;
+    float* prevX;
+    float* prevY;
+    float* width;
+    float* height;
+    PowerupType* type;
+    bool* active;
+    float* speed;
+    int count;
+    int capacity;
+} PowerupPool;
 
 typedef struct {
-    float x, y;
-    float width, height;
-    float lifespan;
-    float currentLife;
-    bool active;
-    bool persistent; // if true, explosion loops in benchmark
-} Explosion;
+    float* x;
+    float* y;
+    float* width;
+    float* height;
+    float* lifespan;
+    float* currentLife;
+    bool* active;
+    bool* persistent; // if true, explosion loops in benchmark
+    // Creation order of transient explosions, wrapping. Saved with the
+    // rest of the pool so the recycle ring can be rebuilt exactly.
+    unsigned* spawnSequence;
+    int count;
+    int capacity;
+
+    // Transient explosions oldest first, for benchmark mode to recycle once
+    // the pool is full: a ring of pool indices from recycleHead, and each
+    // explosion's slot in it (-1 for persistent ones). Code that fills the
+    // pool directly sets recycleCount to -1 to have it rebuilt.
+    int* recycle;
+    int* recycleSlot;
+    int recycleHead;
+    int recycleCount;
+    unsigned nextSpawnSequence;
+} ExplosionPool;
+
+typedef struct {
+    int bullets;
+    int enemies;
+    int enemyBullets;
+    int powerups;
+    int explosions;
+} GameCapacities;
 
 typedef struct {
     int number;
@@ -89,17 +154,21 @@ typedef struct {
     float backgroundOffset;
     float midgroundOffset;   
     float foregroundOffset;  
+    // Scroll offsets at the start of the last tick.
+    float prevBackgroundOffset;
+    float prevMidgroundOffset;
+    float prevForegroundOffset;
     bool bossSpawned;
     bool bossDefeated;
 } Level;
 
 typedef struct {
     Player player;
-    Bullet bullets[MAX_BULLETS];
-    Enemy enemies[MAX_ENEMIES];
-    Bullet enemyBullets[MAX_ENEMY_BULLETS];
-    Powerup powerups[MAX_POWERUPS];
-    Explosion explosions[MAX_EXPLOSIONS];
+    BulletPool bullets;
+    EnemyPool enemies;
+    BulletPool enemyBullets;
+    PowerupPool powerups;
+    ExplosionPool explosions;
     Level level;
     bool gameOver;
     bool paused;
@@ -107,14 +176,52 @@ typedef struct {
     float benchmarkSpawnBand;
     float enemySpawnTimer;
     float powerupSpawnTimer;
+    BroadPhaseKind broadPhase;
+    // When set, every collision pass also runs its queries through all other
+    // broad-phase backends and counts disagreements.
+    bool verifyBroadPhase;
+    int broadPhaseMismatches;
+    // Backs every pool column.
+    Arena storage;
 } GameState;
 
+void gameCapacitiesDefault(GameCapacities* capacities);
+// Parses a comma-separated list of name=count pairs, e.g.
+// "bullets=200000,enemies=50000", over capacities. Names are the
+// GameCapacities fields; fields not named keep their value. Prints the
+// problem and returns false on a malformed list.
+bool gameCapacitiesParse(GameCapacities* capacities, const char* spec);
+
+// Carves the columns of one pool out of arena.
+void bulletPoolAllocate(BulletPool* pool, int capacity, Arena* arena);
+void enemyPoolAllocate(EnemyPool* pool, int capacity, Arena* arena);
+void powerupPoolAllocate(PowerupPool* pool, int capacity, Arena* arena);
+void explosionPoolAllocate(ExplosionPool* pool, int capacity, Arena* arena);
+
+// Allocates every pool from a single arena sized for capacities, replacing
+// any previous allocation, and grows the scratch buffers updateGame and
+// handleCollisions share to match. The pools start empty. initGame calls
+// this with the defaults if a (zeroed) GameState was never allocated.
+void gameAllocate(GameState* gameState, const GameCapacities* capacities);
+void gameFree(GameState* gameState);
+// Copies src into dst, live pool ranges included, keeping dst's own
+// storage. Exits if a src pool holds more entities than dst can.
+void gameCopy(GameState* dst, const GameState* src);
+
 void initGame(GameState* gameState);
+// Makes every previous position equal the current one, so nothing is
+// interpolated until the next tick. For states that did not come from a
+// tick, e.g. a freshly built scene or a loaded savestate.
+void gameSnapInterpolation(GameState* gameState);
 void updateGame(GameState* gameState, float deltaTime);
+// The enemy pass of updateGame on its own: timers, behaviours, movement and
+// despawns or benchmark wraps, with the pool compacted afterwards.
+void updateEnemies(GameState* gameState, float deltaTime);
 void fireBullet(GameState* gameState);
 void spawnEnemy(GameState* gameState, EnemyType type);
 void spawnBoss(GameState* gameState);
 void spawnPowerup(GameState* gameState, float x, float y);
+void createExplosion(GameState* gameState, float x, float y, float size);
 void handleCollisions(GameState* gameState);
 void nextLevel(GameState* gameState);
 
@@ -0,0 +1,42 @@
+#ifndef GRID_H
+#define GRID_H
+
+// Uniform grid for broad-phase collision, stored in compressed-sparse-row form:
+// the entries of cell k are [cellStart[k], cellStart[k + 1]) in one contiguous
+// array, so a cell can hold any number of entities.
+#define GRID_CELL_SIZE 32
+// Use fixed screen size here to avoid macro order issues
+#define GRID_COLS ((480 + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_ROWS ((320 + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_CELLS (GRID_ROWS * GRID_COLS)
+#define GRID_CELL(r, c) ((r) * GRID_COLS + (c))
+
+typedef struct {
+    int cellStart[GRID_CELLS + 1];
+    // Per entry: the entity index and a snapshot of its box taken at build
+    // time. Entries of a cell are in ascending entity order.
+    int* items;
+    float* minX;
+    float* minY;
+    float* maxX;
+    float* maxY;
+    int entryCapacity;
+} CollisionGrid;
+
+// Inclusive range of cells touched by a box, clamped to the grid.
+typedef struct {
+    int colStart;
+    int colEnd;
+    int rowStart;
+    int rowEnd;
+} GridSpan;
+
+GridSpan gridSpan(float minX, float minY, float maxX, float maxY);
+
+// Rebuilds the grid from the first n boxes, given as min/max columns: counts
+// entries per cell, turns the counts into offsets with a prefix sum, then
+// scatters. Storage grows to the largest frame seen and is reused afterwards.
+void gridBuild(CollisionGrid* grid, const float* minX, const float* minY,
+               const float* maxX, const float* maxY, int n);
+
+#endif
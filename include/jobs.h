@@ -0,0 +1,32 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+
+#define JOBS_MAX_THREADS 64
+
+// Processes items [begin, end) of a parallel-for.
+typedef void (*JobRangeFn)(void* ctx, int begin, int end);
+
+// Starts threadCount - 1 worker threads; the calling thread is the remaining
+// one and takes part in every parallel-for. Calling it again restarts the
+// pool with the new size. Returns false if the threads could not be created,
+// in which case everything runs on the calling thread.
+bool jobsInit(int threadCount);
+void jobsShutdown(void);
+int jobsThreadCount(void);
+int jobsHardwareThreads(void);
+// Index of the calling thread in [0, jobsThreadCount()): workers are 1 and
+// up, and every other thread, including the one calling jobsParallelFor,
+// is 0. Lets a JobRangeFn pick per-thread scratch.
+int jobsThreadIndex(void);
+
+// Splits [0, count) into chunks of grain items and runs fn over all of them,
+// returning once every chunk is done. Each thread starts on its own share of
+// the chunks and steals half of another thread's remaining chunks when it
+// runs out. Chunk boundaries depend only on count and grain, never on the
+// thread count. Only one thread at a time may call it (the main thread, or
+// the simulation thread in pipelined mode), and never from inside fn.
+void jobsParallelFor(int count, int grain, JobRangeFn fn, void* ctx);
+
+#endif
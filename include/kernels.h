@@ -0,0 +1,29 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+// Which playfield edges a projectile is culled against.
+#define CULL_LEFT     0x1u
+#define CULL_RIGHT    0x2u
+#define CULL_VERTICAL 0x4u
+
+// Advances x[i] += speed[i] * scale for the first n projectiles and writes, in
+// ascending order, the index of every projectile that ended up fully outside
+// the playfield on one of the edges selected by cullFlags. A projectile is
+// outside the left edge when x < -width, the right edge when x > fieldWidth +
+// width, and vertically when y < -height or y > fieldHeight + height.
+// Returns the number of indices written to outIdx.
+int integrateProjectiles(float* x, const float* y, const float* speed,
+                         const float* width, const float* height, int n,
+                         float scale, float fieldWidth, float fieldHeight,
+                         unsigned cullFlags, int* outIdx);
+
+// Tests one box against n candidate boxes stored as separate min/max columns
+// and writes, in ascending order, the position of every candidate that
+// overlaps it (strict inequalities on all four sides). Returns the number of
+// positions written to outIdx.
+int overlapBoxes(float minX, float minY, float maxX, float maxY,
+                 const float* candMinX, const float* candMinY,
+                 const float* candMaxX, const float* candMaxY,
+                 int n, int* outIdx);
+
+#endif
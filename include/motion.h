@@ -0,0 +1,21 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "game.h"
+
+// Polynomial sine approximation. The argument is reduced to [-pi, pi] and
+// folded onto [0, pi/2], where a degree-11 odd polynomial is used; the
+// absolute error is below 2e-7 for |x| <= 2*pi and below 1.5e-6 for
+// |x| < 1e5, where reduction error dominates. The scalar and vectorized
+// paths perform the same operations and return bit-identical results.
+float motionSin(float x);
+void motionSinBatch(const float* x, float* out, int n);
+
+// Advances the closed-form enemy motion for enemies [begin, end): horizontal
+// drift, the ENEMY_SMALL vertical wobble and the ENEMY_BOSS vertical sweep.
+// The wobble is integrated analytically over the tick, so the path an enemy
+// follows does not depend on the tick rate. Medium and large enemies only
+// drift here; their remaining behaviour stays in updateGame.
+void updateEnemyMotion(EnemyPool* enemies, int begin, int end, float deltaTime, float fieldHeight);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+
+#include "game.h"
+#include "snapshot.h"
+
+// Pipelined mode: updateGame runs on its own thread at a fixed tick and
+// hands the render thread a RenderSnapshot after every batch of ticks,
+// through a lock-free triple buffer. The render thread only ever sees
+// snapshots, never the GameState, which belongs to the simulation thread
+// from pipelineStart until pipelineStop returns.
+
+// Starts the simulation thread on gameState, running at most maxSubsteps
+// ticks per catch-up (see FixedStep). Returns false if the thread could not
+// be created.
+bool pipelineStart(GameState* gameState, double tickSeconds, int maxSubsteps);
+
+// Stops the simulation thread and waits for it. Safe to call when the
+// pipeline is not running.
+void pipelineStop(void);
+
+// False once the simulation thread has finished on its own (game over).
+bool pipelineRunning(void);
+
+// The most recently published snapshot. Stays valid until the next call.
+const RenderSnapshot* pipelineLatest(void);
+
+// Interpolation factor for drawing snapshot now: how much of the following
+// tick has elapsed since the snapshot's tick was due, clamped to [0, 1].
+// A simulation thread that falls behind holds the render at 1.
+float pipelineAlpha(const RenderSnapshot* snapshot);
+
+// Statistics for the last run, only meaningful after pipelineStop: ticks
+// simulated, snapshots published, the longest single updateGame call and
+// the wall time dropped by the substep cap.
+unsigned pipelineTicks(void);
+unsigned pipelinePublished(void);
+double pipelineMaxTickSeconds(void);
+double pipelineDroppedSeconds(void);
+
+// Optional per-tick durations in seconds. The buffer is handed over before
+// pipelineStart; ticks are appended only while logging is switched on (the
+// window thread turns it on and off around the measured interval) and until
+// the buffer is full. pipelineLoggedTicks is read after pipelineStop.
+void pipelineLogTicks(double* samples, int capacity);
+void pipelineSetTickLogging(bool enabled);
+int pipelineLoggedTicks(void);
+
+// Called on the simulation thread after every tick, e.g. to hash the state.
+// Set before pipelineStart; NULL disables it.
+typedef void (*PipelineTickFn)(void* ctx, const GameState* gameState);
+void pipelineOnTick(PipelineTickFn fn, void* ctx);
+
+// Input from the window thread. It is applied by the simulation thread
+// before its next tick, in the same place the serial loop polls events.
+void pipelineSetDirection(Direction direction);
+void pipelineQueueFire(void);
+void pipelineQueueQuit(void);
+
+#endif
@@ -5,6 +5,7 @@
 #include <GL/glew.h>
 
 #include "game.h"
+#include "snapshot.h"
 
 typedef enum {
     SPRITE_PLAYER,
@@ -27,7 +28,13 @@ bool initRenderer();
 
 void destroyRenderer();
 
-void renderGame(GameState* gameState);
+// alpha in [0, 1] blends every moving sprite from where it was before the
+// last tick (0) to where it is now (1); see fixedStepAlpha and pipelineAlpha.
+void renderGame(GameState* gameState, float alpha);
+
+// Draws a snapshot captured by snapshotCapture. Does not touch any GameState,
+// so it can run while another thread advances the simulation.
+void renderSnapshot(const RenderSnapshot* snapshot, float alpha);
 
 void renderGameOver(GameState* gameState);
 
@@ -0,0 +1,71 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "game.h"
+
+// Input recording and deterministic replay. All player input is applied at
+// tick boundaries as one TickInput, so a session is fully described by its
+// seed and the TickInput before every tick; replaying them through initGame
+// and updateGame reproduces the session exactly, which the final state hash
+// stored in the file confirms.
+//
+// File layout (little-endian): "SIRP", u32 version, u32 seed, u32 ticks,
+// u64 final stateHash, then (input byte, repeat count) runs. An input byte
+// holds the direction in bits 0-3, the fire count in bits 4-6 and quit in
+// bit 7, so a typical session takes a few bytes per second.
+
+// Input applied before one tick.
+typedef struct {
+    Direction direction;
+    // Fire presses since the previous tick; fireBullet is called this many
+    // times. More than REPLAY_MAX_FIRES are recorded as REPLAY_MAX_FIRES,
+    // which changes nothing since all but the first hit the cooldown.
+    int fires;
+    bool quit;
+} TickInput;
+
+#define REPLAY_MAX_FIRES 7
+
+void applyTickInput(GameState* gameState, const TickInput* input);
+
+typedef struct {
+    FILE* file;
+    uint32_t seed;
+    uint32_t ticks;
+    unsigned char runInput;
+    unsigned char runLength;
+} ReplayRecorder;
+
+bool replayRecordOpen(ReplayRecorder* recorder, const char* path, uint32_t seed);
+void replayRecordTick(ReplayRecorder* recorder, const TickInput* input);
+// Stores the tick count and the final hash and closes the file.
+bool replayRecordClose(ReplayRecorder* recorder, uint64_t finalHash);
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t pos;
+    uint32_t seed;
+    uint32_t ticks;
+    uint64_t finalHash;
+    uint32_t played;
+    unsigned char runInput;
+    unsigned runLeft;
+} Replay;
+
+// Reads the whole file. Prints the reason and returns false if it is not a
+// replay this build understands.
+bool replayLoad(Replay* replay, const char* path);
+// The input for the next tick; false once every recorded tick was played.
+bool replayNext(Replay* replay, TickInput* input);
+// Compares the state hash after the last played tick with the recorded
+// one and prints the outcome on out. Returns 0 when they match, 1 when the
+// replay was stopped early and 2 when the state diverged.
+int replayCheck(const Replay* replay, uint64_t finalHash, FILE* out);
+void replayFree(Replay* replay);
+
+#endif
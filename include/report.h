@@ -0,0 +1,82 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "broadphase.h"
+#include "game.h"
+
+// Machine-readable benchmark results shared by `space_impact --benchmark`
+// and the simulation benchmark. A report is written as JSON or as two-column
+// CSV (key,value); a JSON report can later be passed back as a baseline.
+
+// Upper bucket edges in milliseconds; the last bucket is open-ended.
+#define REPORT_HISTOGRAM_BUCKETS 10
+
+typedef enum {
+    REPORT_NONE,
+    REPORT_JSON,
+    REPORT_CSV
+} ReportFormat;
+
+// Latency distribution, all values in milliseconds. count == 0 means the
+// run produced no samples of this kind and the block is left out.
+typedef struct {
+    int count;
+    double mean;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+    int histogram[REPORT_HISTOGRAM_BUCKETS];
+} LatencyStats;
+
+typedef struct {
+    const char* tool;
+    int density;
+    int threads;
+    uint32_t seed;
+    BroadPhaseKind broadPhase;
+    bool pipelined;
+    GameCapacities capacities;
+
+    double measuredSeconds;
+    // Zero when the tool does not measure it: simbench has no frames, and
+    // the game's tick rate is pinned to the fixed step.
+    double avgFps;
+    double onePercentLowFps;
+    double ticksPerSecond;
+    LatencyStats frames;
+    LatencyStats ticks;
+
+    // Live entities at the end of the run.
+    int bullets;
+    int enemies;
+    int enemyBullets;
+    int powerups;
+    int explosions;
+    int score;
+} BenchReport;
+
+bool reportFormatFromName(const char* name, ReportFormat* out);
+
+// Fills stats from durations in seconds. Sorts samples in place.
+void latencyStatsCompute(LatencyStats* stats, double* samples, int count);
+
+// Nearest-rank percentile (0-100) of an ascending array.
+double latencyPercentile(const double* sorted, int count, double p);
+
+// Writes the report to path, or to stdout when path is NULL.
+bool reportWrite(const BenchReport* report, ReportFormat format, const char* path);
+
+// Compares the report against a JSON report written earlier and prints one
+// line per shared metric to out. Returns the number of metrics that got
+// worse by more than tolerancePercent, or -1 if the baseline could not be
+// read.
+int reportCompareBaseline(const BenchReport* report, const char* path, double tolerancePercent, FILE* out);
+
+#endif
@@ -3,8 +3,59 @@
 
 #include <stdint.h>
 
+// Counter-based generator (Philox4x32-10). Value number `counter` of stream
+// `stream` under `seed` is a pure function of the three, so any number of
+// streams can be drawn from independently, in any order and on any thread,
+// and still reproduce exactly for the same seed.
+
+// Stream ids. Anything that needs randomness independent of the game's main
+// sequence takes its own id here.
+enum {
+    RNG_STREAM_GLOBAL,
+    RNG_STREAM_BACKGROUND
+};
+
+// A position in one stream. Values are generated four at a time; buffer
+// holds the block that contains counter - 1.
+typedef struct {
+    uint32_t seed;
+    uint32_t stream;
+    uint64_t counter;
+    uint32_t buffer[4];
+} RngStream;
+
+// The four values at counters [4 * block, 4 * block + 4) of a stream.
+void rng_block(uint32_t seed, uint32_t stream, uint64_t block, uint32_t out[4]);
+uint32_t rng_at(uint32_t seed, uint32_t stream, uint64_t counter);
+
+RngStream rng_stream(uint32_t seed, uint32_t stream);
+uint32_t rng_stream_next(RngStream* s);
+// The next n values of s, exactly as n calls to rng_stream_next would return
+// them. Whole blocks are generated several at a time with SIMD.
+void rng_stream_fill(RngStream* s, uint32_t* out, int n);
+
+// Maps a raw value onto [0, range) with Lemire's multiply-shift. The rare
+// values that would bias the result are rejected and replaced from s.
+uint32_t rng_stream_bounded(RngStream* s, uint32_t x, uint32_t range);
+
+// Compatibility shim: a single global sequence, RNG_STREAM_GLOBAL of the
+// seed passed to rng_seed. Values are pre-generated in batches, so rng_u32
+// is normally just a load.
 void rng_seed(uint32_t seed);
 uint32_t rng_u32(void);
+uint32_t rng_current_seed(void);
+// How many values have been drawn from the global sequence since rng_seed.
+uint64_t rng_position(void);
+// Puts the global sequence back where rng_position reported it, as if
+// rng_seed(seed) had been followed by `position` draws.
+void rng_restore(uint32_t seed, uint64_t position);
 
-#endif
+// Bulk and bounded draws from the global sequence. rng_fill_u32 returns the
+// same values as n calls to rng_u32. Ranges are [0, range) and unbiased;
+// floats are [0, 1) with 24 random bits.
+uint32_t rng_range(uint32_t range);
+void rng_fill_u32(uint32_t* out, int n);
+void rng_fill_range(uint32_t* out, int n, uint32_t range);
+void rng_fill_float(float* out, int n);
 
+#endif
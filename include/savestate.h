@@ -0,0 +1,26 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+// Binary savestates: a fixed header with the player, level, timers and the
+// global RNG position, followed by the live range [0, count) of every pool
+// column back to back. Released slots are not stored, so a save is as big
+// as the scene in it.
+//
+// The file is written in host byte order and layout; the header records
+// both, and a file from a different build is rejected rather than
+// misread.
+
+bool saveState(const GameState* gameState, const char* path);
+
+// Maps the file and copies it over gameState: one memcpy per pool column,
+// straight out of the page cache. Settings that are not simulation state
+// (broadPhase, verifyBroadPhase) are kept, so call initGame and apply them
+// first. The pools must have room for the saved counts. Restores the global
+// RNG as well. On failure prints why and leaves gameState untouched.
+bool loadState(GameState* gameState, const char* path);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+// Instanced sprite batches in the order the renderer draws them.
+typedef enum {
+    SNAPSHOT_BULLETS,
+    SNAPSHOT_ENEMY_BULLETS,
+    SNAPSHOT_ENEMIES_SMALL,
+    SNAPSHOT_ENEMIES_MEDIUM,
+    SNAPSHOT_ENEMIES_LARGE,
+    SNAPSHOT_ENEMIES_BOSS,
+    SNAPSHOT_POWERUPS_HEALTH,
+    SNAPSHOT_POWERUPS_RAPID_FIRE,
+    SNAPSHOT_POWERUPS_DOUBLE_BULLET,
+    SNAPSHOT_EXPLOSIONS,
+    SNAPSHOT_BATCH_COUNT
+} SnapshotBatch;
+
+// The renderer draws each instance at mix(prev, current, alpha), where
+// alpha is how far the frame is between the captured tick and the next.
+typedef struct {
+    float x, y;
+    float w, h;
+    float r, g, b, a;
+    float prevX, prevY;
+} SpriteInstance;
+
+// Everything renderGame draws, already packed into per-batch instance data.
+// Batch b occupies instances[batchStart[b], batchStart[b + 1]).
+typedef struct {
+    unsigned tick;
+    // When the captured tick was due, on the pipeline's clock. Set by the
+    // pipeline only; see pipelineAlpha.
+    double tickTime;
+
+    float backgroundOffset;
+    float midgroundOffset;
+    float foregroundOffset;
+    float prevBackgroundOffset;
+    float prevMidgroundOffset;
+    float prevForegroundOffset;
+
+    float playerX, playerY;
+    float prevPlayerX, prevPlayerY;
+    float playerWidth, playerHeight;
+    int lives;
+    int score;
+    bool isRapidFire;
+    bool isDoubleBullet;
+    bool benchmarkMode;
+    bool gameOver;
+
+    int batchStart[SNAPSHOT_BATCH_COUNT + 1];
+    // Room for every pool of the captured GameState at full capacity.
+    SpriteInstance* instances;
+    int instanceCapacity;
+} RenderSnapshot;
+
+// Fills snapshot from the current game state. Only reads gameState. The
+// instance array is (re)allocated when gameState's pools hold more than it
+// has room for, so start from a zeroed snapshot.
+void snapshotCapture(RenderSnapshot* snapshot, const GameState* gameState, unsigned tick);
+
+#endif
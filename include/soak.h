@@ -0,0 +1,72 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "game.h"
+
+// Soak runs: long sessions of real play, driven by the autopilot, watching
+// for costs that only show up deep into a session (more and faster enemies
+// per level, growing scroll offsets, memory that is never given back).
+//
+// Every SOAK_SAMPLE_TICKS the log writes one CSV row of mean and max tick
+// time, live entity counts, the level's difficulty knobs and resident
+// memory, and prints a progress line once a game minute. Tick times are
+// also totalled per level, over every game the run plays.
+
+#define SOAK_TICK_RATE 60
+#define SOAK_SAMPLE_TICKS (10 * SOAK_TICK_RATE)
+
+typedef struct {
+    unsigned ticks;
+    double tickSeconds;
+    double maxTickSeconds;
+    int peakEntities;
+    // Difficulty when the level was last played.
+    float scrollSpeed;
+    float enemySpawnRate;
+} SoakLevelStats;
+
+typedef struct {
+    // CSV samples; NULL when not requested.
+    FILE* file;
+    // Progress lines; NULL for none.
+    FILE* progress;
+    unsigned ticks;
+    // Games started, the first one included.
+    int games;
+
+    // Since the last sample.
+    unsigned windowTicks;
+    double windowSeconds;
+    double windowMax;
+
+    // Index level - 1.
+    SoakLevelStats* levels;
+    int levelCount;
+
+    long startRssKiB;
+    long peakRssKiB;
+} SoakLog;
+
+// Parses a --soak MINUTES argument into the minutes and the ticks they
+// take. Prints why and returns false unless it is a number of minutes
+// that covers at least one tick and at most INT_MAX.
+bool soakParseMinutes(const char* arg, double* minutes, int* ticks);
+
+// path may be NULL for no CSV. Returns false if it cannot be created.
+bool soakOpen(SoakLog* soak, const char* path, FILE* progress);
+
+// Call once after every updateGame, with how long it took.
+void soakTick(SoakLog* soak, const GameState* gameState, double tickSeconds);
+
+// The game ended; the caller starts a new one with initGame.
+void soakGameOver(SoakLog* soak, const GameState* gameState);
+
+// Per-level table and memory growth.
+void soakPrintSummary(const SoakLog* soak, FILE* out);
+
+bool soakClose(SoakLog* soak);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "game.h"
+
+// 64-bit hash of everything that decides how the simulation continues: the
+// live range of every pool, the player, the level, the spawn timers and the
+// position in the global RNG sequence. Two runs that agree on it after every
+// tick simulated the same game. Costs a few tens of microseconds per tick
+// on a full benchmark scene, so it can stay on in CI.
+uint64_t stateHash(const GameState* gameState);
+
+// Per-tick hash log. In record mode every tick appends a "tick hash" line
+// to the file; in verify mode each tick is compared with the next line of a
+// file recorded earlier, and the first divergent tick is reported.
+typedef struct {
+    FILE* file;
+    // Where divergence and the verify summary are printed.
+    FILE* out;
+    bool verify;
+    unsigned tick;
+    unsigned compared;
+    unsigned mismatches;
+    unsigned firstMismatch;
+    bool referenceEnded;
+} StateHashLog;
+
+bool stateHashLogOpen(StateHashLog* log, const char* path, bool verify, uint32_t seed, FILE* out);
+
+// Call once after every updateGame.
+void stateHashLogTick(StateHashLog* log, const GameState* gameState);
+
+// Closes the file and prints a summary of a verify run. Returns false if any
+// tick diverged, or if the reference and the run cover different ticks
+// (nothing compared, or either one ended first).
+bool stateHashLogClose(StateHashLog* log);
+
+#endif
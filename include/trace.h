@@ -0,0 +1,45 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Scoped instrumentation zones, recorded per thread into a ring buffer and
+// written out as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Zones are opened and closed with TRACE_BEGIN("name") / TRACE_END() on the
+// same thread and must nest. Names must be string literals; only the pointer
+// is stored. Without SPACE_TRACE (make TRACE=0) the macros expand to nothing.
+// With it, a zone costs one flag check while recording is off.
+
+#ifdef SPACE_TRACE
+
+#define TRACE_BEGIN(name) traceBegin(name)
+#define TRACE_END() traceEnd()
+#define TRACE_THREAD_NAME(name) traceSetThreadName(name)
+
+#else
+
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END() ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+// Events kept per thread; older ones are overwritten.
+#define TRACE_RING_SIZE 65536
+
+void traceBegin(const char* name);
+void traceEnd(void);
+void traceSetThreadName(const char* name);
+
+// Starts recording. Returns false when tracing was compiled out.
+bool traceStart(void);
+void traceStop(void);
+
+// Writes everything recorded so far and says so on out. Call it while no
+// other thread is inside a zone, e.g. after the simulation thread and
+// parallel-fors are done.
+bool traceWrite(const char* path, FILE* out);
+
+#endif
@@ -0,0 +1,82 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+static size_t alignUp(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+void arenaInit(Arena* arena, size_t size) {
+    // Never empty, so an initialised arena always has a base and can be
+    // told apart from a measuring one.
+    size = alignUp(size > 0 ? size : 1);
+    void* block = NULL;
+    if (posix_memalign(&block, ARENA_ALIGN, size) != 0) {
+        printf("Failed to allocate %zu byte arena\n", size);
+        exit(EXIT_FAILURE);
+    }
+    arena->base = block;
+    memset(arena->base, 0, size);
+    arena->size = size;
+    arena->used = 0;
+}
+
+void* arenaAlloc(Arena* arena, size_t size) {
+    size_t offset = alignUp(arena->used);
+    arena->used = offset + size;
+    if (!arena->base) {
+        return NULL;
+    }
+    if (arena->used > arena->size) {
+        printf("Arena exhausted: %zu of %zu bytes requested\n", arena->used, arena->size);
+        exit(EXIT_FAILURE);
+    }
+    return arena->base + offset;
+}
+
+void arenaFree(Arena* arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+
+void* frameAlloc(FrameArena* frame, size_t size) {
+    size = alignUp(size);
+    frame->frameBytes += size;
+    if (frame->block.base && alignUp(frame->block.used) + size <= frame->block.size) {
+        return arenaAlloc(&frame->block, size);
+    }
+
+    // The link lives in the first ARENA_ALIGN bytes so the payload stays
+    // aligned.
+    void* chunk = NULL;
+    if (posix_memalign(&chunk, ARENA_ALIGN, ARENA_ALIGN + size) != 0) {
+        printf("Failed to allocate %zu bytes of frame memory\n", size);
+        exit(EXIT_FAILURE);
+    }
+    *(void**)chunk = frame->overflow;
+    frame->overflow = chunk;
+    return (unsigned char*)chunk + ARENA_ALIGN;
+}
+
+void frameReset(FrameArena* frame) {
+    if (frame->frameBytes > frame->peakBytes) {
+        frame->peakBytes = frame->frameBytes;
+    }
+    if (frame->overflow) {
+        while (frame->overflow) {
+            void* next = *(void**)frame->overflow;
+            free(frame->overflow);
+            frame->overflow = next;
+        }
+        arenaFree(&frame->block);
+        arenaInit(&frame->block, frame->peakBytes);
+    }
+    frame->block.used = 0;
+    frame->frameBytes = 0;
+}
@@ -0,0 +1,178 @@
+#include "autopilot.h"
+
+// Where the autopilot parks horizontally; the player spawns at 50.
+#define HOME_X 40.0f
+// How far ahead enemy bullets and enemies count as incoming, and how much
+// room to leave above and below them.
+#define BULLET_LOOKAHEAD 150.0f
+#define ENEMY_LOOKAHEAD 80.0f
+#define DODGE_MARGIN 4.0f
+// Incoming objects closer than this are not crossed on the way to a row.
+#define COMMIT_DISTANCE 60.0f
+// Incoming objects considered at once; a boss volley is three.
+#define MAX_THREATS 64
+// Powerups closer than this are worth a detour.
+#define POWERUP_REACH 120.0f
+// Height of a player bullet; it hits what overlaps [y, y + 4).
+#define SHOT_HEIGHT 4.0f
+#define DEADBAND 2.0f
+
+// Player y values that would put the player in the path of something
+// incoming, as open intervals, with how far ahead that something is.
+typedef struct {
+    float from[MAX_THREATS];
+    float to[MAX_THREATS];
+    float distance[MAX_THREATS];
+    int count;
+} Blocked;
+
+static void considerThreat(Blocked* blocked, const Player* p, float x, float y, float w, float h,
+                           float lookahead) {
+    float distance = x - (p->x + p->width);
+    if (distance < -(w + p->width) || distance > lookahead || blocked->count == MAX_THREATS) {
+        return;
+    }
+    blocked->from[blocked->count] = y - p->height - DODGE_MARGIN;
+    blocked->to[blocked->count] = y + h + DODGE_MARGIN;
+    blocked->distance[blocked->count] = distance;
+    blocked->count++;
+}
+
+// Only intervals of objects closer than within count.
+static bool isBlocked(const Blocked* blocked, float y, float within) {
+    for (int i = 0; i < blocked->count; i++) {
+        if (blocked->distance[i] < within && y > blocked->from[i] && y < blocked->to[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The free y in [minY, maxY] closest to want, counting objects closer than
+// within. Interval edges are the only candidates besides want itself.
+// Returns want when nothing is free.
+static float nearestFree(const Blocked* blocked, float want, float within, float minY, float maxY) {
+    if (!isBlocked(blocked, want, within)) {
+        return want;
+    }
+    float best = want;
+    float bestDistance = -1.0f;
+    for (int i = 0; i < 2 * blocked->count; i++) {
+        float y = (i & 1) ? blocked->to[i / 2] : blocked->from[i / 2];
+        if (blocked->distance[i / 2] >= within || y < minY || y > maxY || isBlocked(blocked, y, within)) {
+            continue;
+        }
+        float distance = y > want ? y - want : want - y;
+        if (bestDistance < 0.0f || distance < bestDistance) {
+            best = y;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+static Direction combine(int dx, int dy) {
+    if (dy < 0) {
+        return dx < 0 ? DIR_UP_LEFT : (dx > 0 ? DIR_UP_RIGHT : DIR_UP);
+    }
+    if (dy > 0) {
+        return dx < 0 ? DIR_DOWN_LEFT : (dx > 0 ? DIR_DOWN_RIGHT : DIR_DOWN);
+    }
+    return dx < 0 ? DIR_LEFT : (dx > 0 ? DIR_RIGHT : DIR_NONE);
+}
+
+// Where the player would like to be: level with a nearby powerup, else the
+// boss, else the nearest enemy ahead. Stays put when there is none.
+static float aimRow(const GameState* gameState) {
+    const Player* p = &gameState->player;
+    float nearest = POWERUP_REACH;
+    float aimY = p->y;
+
+    const PowerupPool* powerups = &gameState->powerups;
+    for (int i = 0; i < powerups->count; i++) {
+        float distance = powerups->x[i] - p->x;
+        if (distance >= 0.0f && distance < nearest) {
+            nearest = distance;
+            aimY = powerups->y[i] + powerups->height[i] / 2.0f - p->height / 2.0f;
+        }
+    }
+    if (nearest < POWERUP_REACH) {
+        return aimY;
+    }
+
+    const EnemyPool* enemies = &gameState->enemies;
+    int target = -1;
+    for (int i = 0; i < enemies->count; i++) {
+        if (enemies->x[i] <= p->x + p->width || enemies->x[i] > SCREEN_WIDTH) {
+            continue;
+        }
+        bool boss = enemies->type[i] == ENEMY_BOSS;
+        bool targetBoss = target >= 0 && enemies->type[target] == ENEMY_BOSS;
+        if (target < 0 || boss > targetBoss || (boss == targetBoss && enemies->x[i] < enemies->x[target])) {
+            target = i;
+        }
+    }
+    if (target >= 0) {
+        aimY = enemies->y[target] + enemies->height[target] / 2.0f - SHOT_HEIGHT / 2.0f;
+    }
+    return aimY;
+}
+
+void autopilotInput(const GameState* gameState, TickInput* input) {
+    const Player* p = &gameState->player;
+    float minY = p->height / 2.0f;
+    float maxY = SCREEN_HEIGHT - p->height;
+
+    Blocked blocked;
+    blocked.count = 0;
+    const BulletPool* enemyBullets = &gameState->enemyBullets;
+    for (int i = 0; i < enemyBullets->count; i++) {
+        considerThreat(&blocked, p, enemyBullets->x[i], enemyBullets->y[i], enemyBullets->width[i],
+                       enemyBullets->height[i], BULLET_LOOKAHEAD);
+    }
+    const EnemyPool* enemies = &gameState->enemies;
+    for (int i = 0; i < enemies->count; i++) {
+        considerThreat(&blocked, p, enemies->x[i], enemies->y[i], enemies->width[i], enemies->height[i],
+                       ENEMY_LOOKAHEAD);
+    }
+
+    float want = aimRow(gameState);
+    if (want < minY) want = minY;
+    if (want > maxY) want = maxY;
+    float goal = nearestFree(&blocked, want, BULLET_LOOKAHEAD, minY, maxY);
+
+    // Close in, only move within the gap the player is already in, or out
+    // of the way by the shortest route if it is in nothing's gap.
+    if (isBlocked(&blocked, p->y, COMMIT_DISTANCE)) {
+        goal = nearestFree(&blocked, p->y, COMMIT_DISTANCE, minY, maxY);
+    } else {
+        for (int i = 0; i < blocked.count; i++) {
+            if (blocked.distance[i] >= COMMIT_DISTANCE) {
+                continue;
+            }
+            if (blocked.to[i] <= p->y && goal < blocked.to[i]) {
+                goal = blocked.to[i];
+            } else if (blocked.from[i] >= p->y && goal > blocked.from[i]) {
+                goal = blocked.from[i];
+            }
+        }
+    }
+
+    int dy = 0;
+    if (goal < p->y - DEADBAND) {
+        dy = -1;
+    } else if (goal > p->y + DEADBAND) {
+        dy = 1;
+    }
+
+    int dx = 0;
+    if (p->x > HOME_X + DEADBAND) {
+        dx = -1;
+    } else if (p->x < HOME_X - DEADBAND) {
+        dx = 1;
+    }
+
+    input->direction = combine(dx, dy);
+    input->fires = 1;
+    input->quit = false;
+}
@@ -0,0 +1,506 @@
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "broadphase.h"
+#include "kernels.h"
+
+#define BVH_LEAF_SIZE 4
+// Refitted trees get looser as entities move; rebuild after this many refits.
+#define BVH_REFIT_LIMIT 8
+// Median splits keep the depth at log2(n), far below this.
+#define BVH_STACK_SIZE 64
+
+typedef struct {
+    const char* name;
+    void (*build)(BroadPhase* bp);
+    int (*query)(const BroadPhase* bp, float minX, float minY, float maxX, float maxY,
+                 int* out, BroadPhaseScratch* scratch);
+} BroadPhaseOps;
+
+static void* growArray(void* p, size_t elemSize, int capacity) {
+    void* grown = realloc(p, elemSize * (size_t)capacity);
+    if (!grown) {
+        printf("Failed to allocate broad phase (%d entries)\n", capacity);
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static void reserveBroadPhase(BroadPhase* bp, int n) {
+    if (n <= bp->capacity) {
+        return;
+    }
+
+    int capacity = bp->capacity > 0 ? bp->capacity : 256;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+
+    bp->minX = growArray(bp->minX, sizeof(float), capacity);
+    bp->minY = growArray(bp->minY, sizeof(float), capacity);
+    bp->maxX = growArray(bp->maxX, sizeof(float), capacity);
+    bp->maxY = growArray(bp->maxY, sizeof(float), capacity);
+    bp->results = growArray(bp->results, sizeof(int), capacity);
+    bp->sortTemp = growArray(bp->sortTemp, sizeof(int), capacity);
+    broadPhaseScratchReserve(&bp->queryScratch, capacity);
+    bp->expected = growArray(bp->expected, sizeof(int), capacity);
+
+    bp->sweep.order = growArray(bp->sweep.order, sizeof(int), capacity);
+    bp->sweep.minX = growArray(bp->sweep.minX, sizeof(float), capacity);
+    bp->sweep.minY = growArray(bp->sweep.minY, sizeof(float), capacity);
+    bp->sweep.maxX = growArray(bp->sweep.maxX, sizeof(float), capacity);
+    bp->sweep.maxY = growArray(bp->sweep.maxY, sizeof(float), capacity);
+
+    bp->bvh.nodes = growArray(bp->bvh.nodes, sizeof(BvhNode), 2 * capacity);
+    bp->bvh.items = growArray(bp->bvh.items, sizeof(int), capacity);
+    bp->bvh.builtCount = -1;
+
+    bp->capacity = capacity;
+}
+
+void broadPhaseScratchReserve(BroadPhaseScratch* scratch, int count) {
+    if (count <= scratch->capacity) {
+        return;
+    }
+
+    int capacity = scratch->capacity > 0 ? scratch->capacity : 256;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    scratch->offsets = growArray(scratch->offsets, sizeof(int), capacity);
+    // New entities start unstamped; epoch 0 is never used by a query.
+    scratch->stamps = growArray(scratch->stamps, sizeof(unsigned), capacity);
+    memset(scratch->stamps + scratch->capacity, 0,
+           sizeof(unsigned) * (size_t)(capacity - scratch->capacity));
+    scratch->capacity = capacity;
+}
+
+// Query results are short, so insertion sort is the cheapest way to put them
+// in the canonical ascending order.
+static void sortIndices(int* v, int n) {
+    for (int k = 1; k < n; k++) {
+        int value = v[k];
+        int m = k;
+        while (m > 0 && v[m - 1] > value) {
+            v[m] = v[m - 1];
+            m--;
+        }
+        v[m] = value;
+    }
+}
+
+static bool boxesOverlap(float aMinX, float aMinY, float aMaxX, float aMaxY,
+                         float bMinX, float bMinY, float bMaxX, float bMaxY) {
+    return aMinX < bMaxX && aMaxX > bMinX && aMinY < bMaxY && aMaxY > bMinY;
+}
+
+// Grid ----------------------------------------------------------------------
+
+static void gridBackendBuild(BroadPhase* bp) {
+    gridBuild(&bp->grid, bp->minX, bp->minY, bp->maxX, bp->maxY, bp->count);
+}
+
+static int gridBackendQuery(const BroadPhase* bp, float minX, float minY, float maxX, float maxY,
+                            int* out, BroadPhaseScratch* scratch) {
+    const CollisionGrid* grid = &bp->grid;
+    GridSpan span = gridSpan(minX, minY, maxX, maxY);
+
+    // An entity spanning several cells shows up once per cell, so multi-cell
+    // queries need deduplicating and re-sorting. Dense scenes put hundreds of
+    // entities in a cell, so duplicates are found through the stamps rather
+    // than by scanning what was already reported.
+    bool singleCell = span.rowStart == span.rowEnd && span.colStart == span.colEnd;
+    unsigned epoch = 0;
+    if (!singleCell) {
+        epoch = ++scratch->epoch;
+        if (epoch == 0) {
+            memset(scratch->stamps, 0, sizeof(unsigned) * (size_t)scratch->capacity);
+            epoch = scratch->epoch = 1;
+        }
+    }
+
+    int* offsets = scratch->offsets;
+    unsigned* stamps = scratch->stamps;
+    int count = 0;
+    for (int r = span.rowStart; r <= span.rowEnd; r++) {
+        for (int c = span.colStart; c <= span.colEnd; c++) {
+            int begin = grid->cellStart[GRID_CELL(r, c)];
+            int end = grid->cellStart[GRID_CELL(r, c) + 1];
+            int hits = overlapBoxes(minX, minY, maxX, maxY,
+                                    grid->minX + begin, grid->minY + begin,
+                                    grid->maxX + begin, grid->maxY + begin,
+                                    end - begin, offsets);
+            if (singleCell) {
+                for (int h = 0; h < hits; h++) {
+                    out[count++] = grid->items[begin + offsets[h]];
+                }
+                continue;
+            }
+            for (int h = 0; h < hits; h++) {
+                int j = grid->items[begin + offsets[h]];
+                if (stamps[j] != epoch) {
+                    stamps[j] = epoch;
+                    out[count++] = j;
+                }
+            }
+        }
+    }
+
+    if (!singleCell) {
+        sortIndices(out, count);
+    }
+    return count;
+}
+
+// Sort and sweep --------------------------------------------------------------
+
+// Maps a float to an unsigned key with the same ordering.
+static unsigned sortableKey(float f) {
+    unsigned u;
+    memcpy(&u, &f, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+static void radixSortByKey(int* order, int* temp, const float* keys, int n) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        int offsets[257] = {0};
+        for (int k = 0; k < n; k++) {
+            offsets[((sortableKey(keys[order[k]]) >> shift) & 0xffu) + 1]++;
+        }
+        for (int d = 0; d < 256; d++) {
+            offsets[d + 1] += offsets[d];
+        }
+        for (int k = 0; k < n; k++) {
+            temp[offsets[(sortableKey(keys[order[k]]) >> shift) & 0xffu]++] = order[k];
+        }
+        memcpy(order, temp, sizeof(int) * (size_t)n);
+    }
+}
+
+static void sweepBackendBuild(BroadPhase* bp) {
+    SweepState* s = &bp->sweep;
+    int n = bp->count;
+
+    // Entities are identified by pool index, so keep the previous order for
+    // indices that still exist and append the new ones at the end.
+    if (n != s->count) {
+        int kept = 0;
+        for (int k = 0; k < s->count; k++) {
+            if (s->order[k] < n) {
+                s->order[kept++] = s->order[k];
+            }
+        }
+        for (int i = s->count; i < n; i++) {
+            s->order[kept++] = i;
+        }
+        s->count = n;
+    }
+
+    // Frame-to-frame the order barely changes and insertion sort is close to
+    // linear. Respawns and pool compaction can scramble it, in which case fall
+    // back to a radix sort.
+    long shifts = 0;
+    long budget = 4L * n + 64;
+    for (int k = 1; k < n; k++) {
+        int idx = s->order[k];
+        float key = bp->minX[idx];
+        int m = k;
+        while (m > 0 && bp->minX[s->order[m - 1]] > key) {
+            s->order[m] = s->order[m - 1];
+            m--;
+        }
+        s->order[m] = idx;
+        shifts += k - m;
+        if (shifts > budget) {
+            radixSortByKey(s->order, bp->sortTemp, bp->minX, n);
+            break;
+        }
+    }
+
+    s->maxWidth = 0.0f;
+    for (int k = 0; k < n; k++) {
+        int i = s->order[k];
+        s->minX[k] = bp->minX[i];
+        s->minY[k] = bp->minY[i];
+        s->maxX[k] = bp->maxX[i];
+        s->maxY[k] = bp->maxY[i];
+        if (s->maxX[k] - s->minX[k] > s->maxWidth) {
+            s->maxWidth = s->maxX[k] - s->minX[k];
+        }
+    }
+}
+
+// First position whose value is not below key.
+static int lowerBound(const float* v, int n, float key) {
+    int lo = 0;
+    int hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (v[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int sweepBackendQuery(const BroadPhase* bp, float minX, float minY, float maxX, float maxY,
+                             int* out, BroadPhaseScratch* scratch) {
+    const SweepState* s = &bp->sweep;
+
+    // Nothing starting more than maxWidth left of the query can reach it; the
+    // extra pixel absorbs rounding in the subtraction.
+    int lo = lowerBound(s->minX, s->count, minX - s->maxWidth - 1.0f);
+    int hi = lowerBound(s->minX, s->count, maxX);
+    if (hi <= lo) {
+        return 0;
+    }
+
+    int hits = overlapBoxes(minX, minY, maxX, maxY,
+                            s->minX + lo, s->minY + lo, s->maxX + lo, s->maxY + lo,
+                            hi - lo, scratch->offsets);
+    for (int h = 0; h < hits; h++) {
+        out[h] = s->order[lo + scratch->offsets[h]];
+    }
+    sortIndices(out, hits);
+    return hits;
+}
+
+// Bounding volume hierarchy -----------------------------------------------------
+
+static float centroid(const BroadPhase* bp, int i, int axis) {
+    return axis == 0 ? bp->minX[i] + bp->maxX[i] : bp->minY[i] + bp->maxY[i];
+}
+
+// Quickselect: reorders items[start, end) so that items[mid] has the centroid
+// it would have if the range were sorted, with nothing larger before it and
+// nothing smaller after it.
+static void selectMedian(const BroadPhase* bp, int* items, int start, int end, int mid, int axis) {
+    while (end - start > 1) {
+        float pivot = centroid(bp, items[start + (end - start) / 2], axis);
+        int i = start;
+        int j = end - 1;
+        while (i <= j) {
+            while (centroid(bp, items[i], axis) < pivot) i++;
+            while (centroid(bp, items[j], axis) > pivot) j--;
+            if (i <= j) {
+                int tmp = items[i];
+                items[i] = items[j];
+                items[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+
+        if (mid <= j) {
+            end = j + 1;
+        } else if (mid >= i) {
+            start = i;
+        } else {
+            return;
+        }
+    }
+}
+
+static void bvhLeafBounds(const BroadPhase* bp, BvhNode* node) {
+    node->minX = FLT_MAX;
+    node->minY = FLT_MAX;
+    node->maxX = -FLT_MAX;
+    node->maxY = -FLT_MAX;
+    for (int k = node->start; k < node->start + node->count; k++) {
+        int i = bp->bvh.items[k];
+        if (bp->minX[i] < node->minX) node->minX = bp->minX[i];
+        if (bp->minY[i] < node->minY) node->minY = bp->minY[i];
+        if (bp->maxX[i] > node->maxX) node->maxX = bp->maxX[i];
+        if (bp->maxY[i] > node->maxY) node->maxY = bp->maxY[i];
+    }
+}
+
+static void bvhBuildNode(BroadPhase* bp, int nodeIndex, int start, int count) {
+    BvhState* bvh = &bp->bvh;
+    BvhNode* node = &bvh->nodes[nodeIndex];
+
+    node->start = start;
+    node->count = count;
+    node->child = -1;
+    bvhLeafBounds(bp, node);
+    if (count <= BVH_LEAF_SIZE) {
+        return;
+    }
+
+    // Split at the median centroid along the node's longer side.
+    int axis = (node->maxX - node->minX >= node->maxY - node->minY) ? 0 : 1;
+    int half = count / 2;
+    selectMedian(bp, bvh->items, start, start + count, start + half, axis);
+
+    node->count = 0;
+    node->child = bvh->nodeCount;
+    bvh->nodeCount += 2;
+    bvhBuildNode(bp, node->child, start, half);
+    bvhBuildNode(bp, node->child + 1, start + half, count - half);
+}
+
+static void bvhRefit(BroadPhase* bp) {
+    BvhState* bvh = &bp->bvh;
+    // Children are always allocated after their parent.
+    for (int k = bvh->nodeCount - 1; k >= 0; k--) {
+        BvhNode* node = &bvh->nodes[k];
+        if (node->count > 0) {
+            bvhLeafBounds(bp, node);
+            continue;
+        }
+        const BvhNode* a = &bvh->nodes[node->child];
+        const BvhNode* b = &bvh->nodes[node->child + 1];
+        node->minX = a->minX < b->minX ? a->minX : b->minX;
+        node->minY = a->minY < b->minY ? a->minY : b->minY;
+        node->maxX = a->maxX > b->maxX ? a->maxX : b->maxX;
+        node->maxY = a->maxY > b->maxY ? a->maxY : b->maxY;
+    }
+}
+
+static void bvhBackendBuild(BroadPhase* bp) {
+    BvhState* bvh = &bp->bvh;
+    int n = bp->count;
+
+    if (n > 0 && n == bvh->builtCount && bvh->refits < BVH_REFIT_LIMIT) {
+        bvhRefit(bp);
+        bvh->refits++;
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        bvh->items[i] = i;
+    }
+    bvh->nodeCount = 0;
+    if (n > 0) {
+        bvh->nodeCount = 1;
+        bvhBuildNode(bp, 0, 0, n);
+    }
+    bvh->builtCount = n;
+    bvh->refits = 0;
+}
+
+static int bvhBackendQuery(const BroadPhase* bp, float minX, float minY, float maxX, float maxY,
+                           int* out, BroadPhaseScratch* scratch) {
+    (void)scratch;
+
+    const BvhState* bvh = &bp->bvh;
+    if (bvh->nodeCount == 0) {
+        return 0;
+    }
+
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    int count = 0;
+    while (top > 0) {
+        const BvhNode* node = &bvh->nodes[stack[--top]];
+        if (!boxesOverlap(minX, minY, maxX, maxY, node->minX, node->minY, node->maxX, node->maxY)) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            stack[top++] = node->child;
+            stack[top++] = node->child + 1;
+            continue;
+        }
+
+        for (int k = node->start; k < node->start + node->count; k++) {
+            int i = bvh->items[k];
+            if (boxesOverlap(minX, minY, maxX, maxY, bp->minX[i], bp->minY[i], bp->maxX[i], bp->maxY[i])) {
+                out[count++] = i;
+            }
+        }
+    }
+
+    sortIndices(out, count);
+    return count;
+}
+
+// Interface -------------------------------------------------------------------
+
+static const BroadPhaseOps backends[BROADPHASE_KIND_COUNT] = {
+    { "grid", gridBackendBuild, gridBackendQuery },
+    { "sap", sweepBackendBuild, sweepBackendQuery },
+    { "bvh", bvhBackendBuild, bvhBackendQuery },
+};
+
+const char* broadPhaseName(BroadPhaseKind kind) {
+    return backends[kind].name;
+}
+
+bool broadPhaseFromName(const char* name, BroadPhaseKind* kind) {
+    for (int k = 0; k < BROADPHASE_KIND_COUNT; k++) {
+        if (strcmp(name, backends[k].name) == 0) {
+            *kind = (BroadPhaseKind)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+void broadPhaseBuild(BroadPhase* bp, const float* x, const float* y,
+                     const float* width, const float* height, int n) {
+    reserveBroadPhase(bp, n);
+    for (int i = 0; i < n; i++) {
+        bp->minX[i] = x[i];
+        bp->minY[i] = y[i];
+        bp->maxX[i] = x[i] + width[i];
+        bp->maxY[i] = y[i] + height[i];
+    }
+    bp->count = n;
+    backends[bp->kind].build(bp);
+}
+
+int broadPhaseQuery(BroadPhase* bp, float minX, float minY, float maxX, float maxY) {
+    return backends[bp->kind].query(bp, minX, minY, maxX, maxY, bp->results, &bp->queryScratch);
+}
+
+int broadPhaseQueryInto(const BroadPhase* bp, float minX, float minY, float maxX, float maxY,
+                        int* out, BroadPhaseScratch* scratch) {
+    return backends[bp->kind].query(bp, minX, minY, maxX, maxY, out, scratch);
+}
+
+int broadPhaseCrossCheck(BroadPhase* bp, const float* x, const float* y,
+                         const float* width, const float* height, int n) {
+    for (int k = 0; k < BROADPHASE_KIND_COUNT; k++) {
+        if (k != (int)bp->kind) {
+            backends[k].build(bp);
+        }
+    }
+
+    int mismatches = 0;
+    for (int q = 0; q < n; q++) {
+        float qMinX = x[q];
+        float qMinY = y[q];
+        float qMaxX = x[q] + width[q];
+        float qMaxY = y[q] + height[q];
+
+        // Reference: every snapshot box, in index order, so the result is
+        // already ascending and unique.
+        int expectedCount = 0;
+        for (int i = 0; i < bp->count; i++) {
+            if (boxesOverlap(qMinX, qMinY, qMaxX, qMaxY, bp->minX[i], bp->minY[i], bp->maxX[i], bp->maxY[i])) {
+                bp->expected[expectedCount++] = i;
+            }
+        }
+
+        for (int k = 0; k < BROADPHASE_KIND_COUNT; k++) {
+            int count = backends[k].query(bp, qMinX, qMinY, qMaxX, qMaxY, bp->results, &bp->queryScratch);
+            bool same = count == expectedCount;
+            for (int h = 0; same && h < count; h++) {
+                same = bp->results[h] == bp->expected[h];
+            }
+            if (!same) {
+                mismatches++;
+                break;
+            }
+        }
+    }
+    return mismatches;
+}
@@ -0,0 +1,31 @@
+#include "fixedstep.h"
+
+void fixedStepInit(FixedStep* step, double tickSeconds, int maxSubsteps, double now) {
+    step->tickSeconds = tickSeconds;
+    step->maxSubsteps = maxSubsteps > 0 ? maxSubsteps : 0;
+    step->lastTime = now;
+    step->accumulator = 0.0;
+    step->droppedSeconds = 0.0;
+}
+
+int fixedStepAdvance(FixedStep* step, double now) {
+    step->accumulator += now - step->lastTime;
+    step->lastTime = now;
+
+    int ticks = 0;
+    while (step->accumulator >= step->tickSeconds) {
+        step->accumulator -= step->tickSeconds;
+        ticks++;
+    }
+
+    if (step->maxSubsteps > 0 && ticks > step->maxSubsteps) {
+        step->droppedSeconds += (double)(ticks - step->maxSubsteps) * step->tickSeconds;
+        ticks = step->maxSubsteps;
+    }
+    return ticks;
+}
+
+float fixedStepAlpha(const FixedStep* step) {
+    float alpha = (float)(step->accumulator / step->tickSeconds);
+    return alpha < 1.0f ? alpha : 1.0f;
+}
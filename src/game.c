@@ -1,141 +1,286 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "game.h"
+#include "jobs.h"
+#include "kernels.h"
+#include "motion.h"
 #include "rng.h"
+#include "trace.h"
 
 static void respawnEnemyRight(GameState* gameState, int idx);
+static void handleCollisionsPlay(GameState* gameState);
+static void handleCollisionsBench(GameState* gameState);
+
+// Broad-phase structures, rebuilt at the start of every collision pass.
+static BroadPhase enemyBroadPhase;
+static BroadPhase enemyBulletBroadPhase;
+static BroadPhase powerupBroadPhase;
+
+// Entities per parallel-for chunk in updateGame.
+#define SIM_GRAIN 256
+
+// Per-thread memory for the parallel passes. frame holds everything that
+// only lives for one pass, sized by the live entity counts, and is reset at
+// the start of every updateGame and handleCollisions; query keeps its
+// broad-phase stamps across ticks so they never need clearing.
+typedef struct {
+    FrameArena frame;
+    BroadPhaseScratch query;
+    int* hits;
+    int hitsCapacity;
+} ThreadScratch;
+
+static ThreadScratch threadScratch[JOBS_MAX_THREADS];
+
+static void beginFrame(void) {
+    for (int t = 0; t < JOBS_MAX_THREADS; t++) {
+        frameReset(&threadScratch[t].frame);
+    }
+}
 
-// Simple uniform grid for broad-phase collision between bullets and enemies
-#define GRID_CELL_SIZE 32
-// Use fixed screen size here to avoid macro order issues
-#define GRID_COLS ((480 + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
-#define GRID_ROWS ((320 + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
-#define GRID_MAX_PER_CELL 64
-
-static int enemyGrid[GRID_ROWS][GRID_COLS][GRID_MAX_PER_CELL];
-static int enemyGridCount[GRID_ROWS][GRID_COLS];
+// Frame memory of the calling thread.
+static void* frameScratch(size_t size) {
+    return frameAlloc(&threadScratch[jobsThreadIndex()].frame, size);
+}
 
-static int enemyBulletGrid[GRID_ROWS][GRID_COLS][GRID_MAX_PER_CELL];
-static int enemyBulletGridCount[GRID_ROWS][GRID_COLS];
+// Scratch list of projectile indices handed back by integrateProjectiles.
+// Each chunk writes its own slice starting at the chunk's first index.
+static int* culledIndices;
+static int* chunkCulled;
+
+// Bullets per parallel-for chunk in the bullet-vs-enemy detection pass.
+#define COLLISION_GRAIN 64
+
+// Enemy candidates found by the detection pass for one chunk of bullets,
+// stored back to back in bullet order in the frame memory of the thread
+// that ran the chunk.
+typedef struct {
+    int* enemies;
+    int count;
+    int capacity;
+} HitCandidates;
+
+static HitCandidates* hitCandidates;
+static int* bulletCandidateCount;
+
+// What the serial pass after the parallel enemy update still has to do for
+// each enemy.
+enum {
+    ENEMY_EVENT_NONE,
+    // Timer expired: retarget (RNG) or fire (enemy bullet pool), then the
+    // rest of the tick.
+    ENEMY_EVENT_BEHAVIOUR,
+    // Left the playfield in benchmark mode: respawn at a random position.
+    ENEMY_EVENT_WRAP
+};
+static unsigned char* enemyEvents;
+static bool* powerupWrapPending;
+
+#define CHUNKS(n, grain) (((n) + (grain) - 1) / (grain))
+
+// Passes that behave differently in benchmark mode are written once, as a
+// *Mode function taking the mode as its first argument, and MODE_INSTANCES
+// stamps out a Play and a Bench copy with the mode fixed. Inlined into those
+// the mode tests fold away, so each copy's per-entity loops only carry the
+// code its mode runs. updateGame and handleCollisions pick the copies once
+// per tick.
+#define MODE_PLAY false
+#define MODE_BENCH true
+#if defined(__GNUC__)
+#define MODE_INLINE static inline __attribute__((always_inline))
+#else
+#define MODE_INLINE static inline
+#endif
+#define MODE_INSTANCES(name, params, ...)                                   \
+    static void name##Play params { name##Mode(MODE_PLAY, __VA_ARGS__); }   \
+    static void name##Bench params { name##Mode(MODE_BENCH, __VA_ARGS__); }
+
+#define CARVE(base, column, capacity, arena) \
+    ((base)->column = arenaAlloc((arena), sizeof((base)->column[0]) * (size_t)(capacity)))
+
+// Pools keep their live entities packed in [0, count), so the free slots are
+// always the tail and acquiring one is O(1). Despawning only clears the active
+// flag; the compact*() helpers swap-remove dead entries once a pass is done, so
+// indices stay stable while that pass (or the collision grids) still refers to
+// them.
+static int acquireSlot(int* count, int capacity, bool* active) {
+    if (*count >= capacity) {
+        return -1;
+    }
+    int idx = (*count)++;
+    active[idx] = true;
+    return idx;
+}
 
-static int powerupGrid[GRID_ROWS][GRID_COLS][GRID_MAX_PER_CELL];
-static int powerupGridCount[GRID_ROWS][GRID_COLS];
+#define POOL_ACQUIRE(pool) acquireSlot(&(pool).count, (pool).capacity, (pool).active)
+#define POOL_RELEASE(pool, idx) ((pool).active[(idx)] = false)
+// A spawned or teleported entity has no previous position to blend from.
+#define SNAP_PREVIOUS(pool, idx) \
+    ((pool).prevX[(idx)] = (pool).x[(idx)], (pool).prevY[(idx)] = (pool).y[(idx)])
 
-static int clampInt(int v, int min, int max) {
-    if (v < min) return min;
-    if (v > max) return max;
-    return v;
-}
+#define SWAP_REMOVE(pool, column, i, last) ((pool)->column[(i)] = (pool)->column[(last)])
 
-static void buildEnemyGrid(GameState* gameState) {
-    for (int r = 0; r < GRID_ROWS; r++) {
-        for (int c = 0; c < GRID_COLS; c++) {
-            enemyGridCount[r][c] = 0;
+static void compactBullets(BulletPool* pool) {
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->active[i]) {
+            i++;
+            continue;
         }
+        int last = --pool->count;
+        SWAP_REMOVE(pool, x, i, last);
+        SWAP_REMOVE(pool, y, i, last);
+        SWAP_REMOVE(pool, prevX, i, last);
+        SWAP_REMOVE(pool, prevY, i, last);
+        SWAP_REMOVE(pool, width, i, last);
+        SWAP_REMOVE(pool, height, i, last);
+        SWAP_REMOVE(pool, speed, i, last);
+        SWAP_REMOVE(pool, active, i, last);
     }
+}
 
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (!gameState->enemies[i].active) {
+static void compactEnemies(EnemyPool* pool) {
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->active[i]) {
+            i++;
             continue;
         }
-
-        float exMin = gameState->enemies[i].x;
-        float exMax = gameState->enemies[i].x + gameState->enemies[i].width;
-        float eyMin = gameState->enemies[i].y;
-        float eyMax = gameState->enemies[i].y + gameState->enemies[i].height;
-
-        int colStart = clampInt((int)(exMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int colEnd   = clampInt((int)(exMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int rowStart = clampInt((int)(eyMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-        int rowEnd   = clampInt((int)(eyMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-        for (int r = rowStart; r <= rowEnd; r++) {
-            for (int c = colStart; c <= colEnd; c++) {
-                int count = enemyGridCount[r][c];
-                if (count < GRID_MAX_PER_CELL) {
-                    enemyGrid[r][c][count] = i;
-                    enemyGridCount[r][c] = count + 1;
-                }
-            }
-        }
+        int last = --pool->count;
+        SWAP_REMOVE(pool, x, i, last);
+        SWAP_REMOVE(pool, y, i, last);
+        SWAP_REMOVE(pool, prevX, i, last);
+        SWAP_REMOVE(pool, prevY, i, last);
+        SWAP_REMOVE(pool, width, i, last);
+        SWAP_REMOVE(pool, height, i, last);
+        SWAP_REMOVE(pool, speed, i, last);
+        SWAP_REMOVE(pool, health, i, last);
+        SWAP_REMOVE(pool, type, i, last);
+        SWAP_REMOVE(pool, active, i, last);
+        SWAP_REMOVE(pool, bulletCooldown, i, last);
+        SWAP_REMOVE(pool, movementPattern, i, last);
+        SWAP_REMOVE(pool, score, i, last);
     }
 }
 
-static void buildEnemyBulletGrid(GameState* gameState) {
-    for (int r = 0; r < GRID_ROWS; r++) {
-        for (int c = 0; c < GRID_COLS; c++) {
-            enemyBulletGridCount[r][c] = 0;
+static void compactPowerups(PowerupPool* pool) {
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->active[i]) {
+            i++;
+            continue;
         }
+        int last = --pool->count;
+        SWAP_REMOVE(pool, x, i, last);
+        SWAP_REMOVE(pool, y, i, last);
+        SWAP_REMOVE(pool, prevX, i, last);
+        SWAP_REMOVE(pool, prevY, i, last);
+        SWAP_REMOVE(pool, width, i, last);
+        SWAP_REMOVE(pool, height, i, last);
+        SWAP_REMOVE(pool, type, i, last);
+        SWAP_REMOVE(pool, active, i, last);
+        SWAP_REMOVE(pool, speed, i, last);
     }
+}
 
-    for (int i = 0; i < MAX_ENEMY_BULLETS; i++) {
-        if (!gameState->enemyBullets[i].active) {
-            continue;
-        }
+// Transient explosions all live as long, so the oldest one is the one
+// closest to expiring; compactExplosions keeps the ring's indices current.
+static void recyclePush(ExplosionPool* pool, int idx) {
+    int slot = (pool->recycleHead + pool->recycleCount) % pool->capacity;
+    pool->recycle[slot] = idx;
+    pool->recycleSlot[idx] = slot;
+    pool->recycleCount++;
+}
 
-        float bxMin = gameState->enemyBullets[i].x;
-        float bxMax = gameState->enemyBullets[i].x + gameState->enemyBullets[i].width;
-        float byMin = gameState->enemyBullets[i].y;
-        float byMax = gameState->enemyBullets[i].y + gameState->enemyBullets[i].height;
-
-        int colStart = clampInt((int)(bxMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int colEnd   = clampInt((int)(bxMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int rowStart = clampInt((int)(byMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-        int rowEnd   = clampInt((int)(byMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-        for (int r = rowStart; r <= rowEnd; r++) {
-            for (int c = colStart; c <= colEnd; c++) {
-                int count = enemyBulletGridCount[r][c];
-                if (count < GRID_MAX_PER_CELL) {
-                    enemyBulletGrid[r][c][count] = i;
-                    enemyBulletGridCount[r][c] = count + 1;
-                }
-            }
-        }
-    }
+static int recyclePop(ExplosionPool* pool) {
+    int idx = pool->recycle[pool->recycleHead];
+    pool->recycleHead = (pool->recycleHead + 1) % pool->capacity;
+    pool->recycleCount--;
+    pool->recycleSlot[idx] = -1;
+    return idx;
+}
+
+static const unsigned* sortSequence;
+
+static int compareSpawnSequence(const void* a, const void* b) {
+    // Differences rather than values, so the order survives wrapping.
+    int d = (int)(sortSequence[*(const int*)a] - sortSequence[*(const int*)b]);
+    return (d > 0) - (d < 0);
 }
 
-static void buildPowerupGrid(GameState* gameState) {
-    for (int r = 0; r < GRID_ROWS; r++) {
-        for (int c = 0; c < GRID_COLS; c++) {
-            powerupGridCount[r][c] = 0;
+// Orders the transient explosions by spawnSequence and renumbers them from 0.
+static void rebuildRecycleRing(ExplosionPool* pool) {
+    int count = 0;
+    for (int i = 0; i < pool->count; i++) {
+        pool->recycleSlot[i] = -1;
+        if (!pool->persistent[i]) {
+            pool->recycle[count++] = i;
         }
     }
+    sortSequence = pool->spawnSequence;
+    qsort(pool->recycle, (size_t)count, sizeof(int), compareSpawnSequence);
+
+    pool->recycleHead = 0;
+    pool->recycleCount = 0;
+    for (int k = 0; k < count; k++) {
+        pool->spawnSequence[pool->recycle[k]] = (unsigned)k;
+        recyclePush(pool, pool->recycle[k]);
+    }
+    pool->nextSpawnSequence = (unsigned)count;
+}
 
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (!gameState->powerups[i].active) {
+static void compactExplosions(ExplosionPool* pool) {
+    bool ringValid = pool->recycleCount >= 0;
+    bool holes = false;
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->active[i]) {
+            i++;
             continue;
         }
+        int last = --pool->count;
+        if (ringValid) {
+            if (pool->recycleSlot[i] >= 0) {
+                pool->recycle[pool->recycleSlot[i]] = -1;
+                holes = true;
+            }
+            if (last != i && pool->recycleSlot[last] >= 0) {
+                pool->recycle[pool->recycleSlot[last]] = i;
+            }
+        }
+        SWAP_REMOVE(pool, x, i, last);
+        SWAP_REMOVE(pool, y, i, last);
+        SWAP_REMOVE(pool, width, i, last);
+        SWAP_REMOVE(pool, height, i, last);
+        SWAP_REMOVE(pool, lifespan, i, last);
+        SWAP_REMOVE(pool, currentLife, i, last);
+        SWAP_REMOVE(pool, active, i, last);
+        SWAP_REMOVE(pool, persistent, i, last);
+        SWAP_REMOVE(pool, spawnSequence, i, last);
+        SWAP_REMOVE(pool, recycleSlot, i, last);
+    }
 
-        float pxMin = gameState->powerups[i].x;
-        float pxMax = gameState->powerups[i].x + gameState->powerups[i].width;
-        float pyMin = gameState->powerups[i].y;
-        float pyMax = gameState->powerups[i].y + gameState->powerups[i].height;
-
-        int colStart = clampInt((int)(pxMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int colEnd   = clampInt((int)(pxMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int rowStart = clampInt((int)(pyMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-        int rowEnd   = clampInt((int)(pyMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-        for (int r = rowStart; r <= rowEnd; r++) {
-            for (int c = colStart; c <= colEnd; c++) {
-                int count = powerupGridCount[r][c];
-                if (count < GRID_MAX_PER_CELL) {
-                    powerupGrid[r][c][count] = i;
-                    powerupGridCount[r][c] = count + 1;
-                }
+    // Close the ring over the released ones, keeping the order.
+    if (holes) {
+        int kept = 0;
+        for (int k = 0; k < pool->recycleCount; k++) {
+            int idx = pool->recycle[(pool->recycleHead + k) % pool->capacity];
+            if (idx >= 0) {
+                int slot = (pool->recycleHead + kept++) % pool->capacity;
+                pool->recycle[slot] = idx;
+                pool->recycleSlot[idx] = slot;
             }
         }
+        pool->recycleCount = kept;
     }
 }
 
 #define PLAYER_SPEED 150.0f
 #define BULLET_SPEED 300.0f
 #define ENEMY_BULLET_SPEED 200.0f
-#define SCREEN_WIDTH 480
-#define SCREEN_HEIGHT 320
 #define PLAYER_WIDTH 32
 #define PLAYER_HEIGHT 16
 #define BULLET_WIDTH 8
@@ -148,7 +293,237 @@ static void buildPowerupGrid(GameState* gameState) {
 #define ENEMY_SPAWN_DELAY 2.0f
 #define POWERUP_SPAWN_DELAY 15.0f
 
+#define MAX_CAPACITY (1 << 24)
+
+void gameCapacitiesDefault(GameCapacities* capacities) {
+    capacities->bullets = DEFAULT_MAX_BULLETS;
+    capacities->enemies = DEFAULT_MAX_ENEMIES;
+    capacities->enemyBullets = DEFAULT_MAX_ENEMY_BULLETS;
+    capacities->powerups = DEFAULT_MAX_POWERUPS;
+    capacities->explosions = DEFAULT_MAX_EXPLOSIONS;
+}
+
+static int* capacityField(GameCapacities* capacities, const char* name, size_t length) {
+    struct { const char* name; int* field; } fields[] = {
+        { "bullets", &capacities->bullets },
+        { "enemies", &capacities->enemies },
+        { "enemyBullets", &capacities->enemyBullets },
+        { "powerups", &capacities->powerups },
+        { "explosions", &capacities->explosions },
+    };
+    for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+        if (strlen(fields[f].name) == length && strncmp(fields[f].name, name, length) == 0) {
+            return fields[f].field;
+        }
+    }
+    return NULL;
+}
+
+bool gameCapacitiesParse(GameCapacities* capacities, const char* spec) {
+    GameCapacities parsed = *capacities;
+    const char* p = spec;
+    while (*p) {
+        const char* eq = strchr(p, '=');
+        int* field = eq ? capacityField(&parsed, p, (size_t)(eq - p)) : NULL;
+        char* end = NULL;
+        long value = field ? strtol(eq + 1, &end, 10) : -1;
+        if (!field || end == eq + 1 || (*end != ',' && *end != '\0') || value < 0 || value > MAX_CAPACITY) {
+            printf("Invalid capacity list \"%s\": expected name=count pairs with count in [0, %d] "
+                   "and name one of bullets, enemies, enemyBullets, powerups, explosions\n",
+                   spec, MAX_CAPACITY);
+            return false;
+        }
+        *field = (int)value;
+        p = *end == ',' ? end + 1 : end;
+    }
+    *capacities = parsed;
+    return true;
+}
+
+void bulletPoolAllocate(BulletPool* pool, int capacity, Arena* arena) {
+    CARVE(pool, x, capacity, arena);
+    CARVE(pool, y, capacity, arena);
+    CARVE(pool, prevX, capacity, arena);
+    CARVE(pool, prevY, capacity, arena);
+    CARVE(pool, width, capacity, arena);
+    CARVE(pool, height, capacity, arena);
+    CARVE(pool, speed, capacity, arena);
+    CARVE(pool, active, capacity, arena);
+    pool->count = 0;
+    pool->capacity = capacity;
+}
+
+void enemyPoolAllocate(EnemyPool* pool, int capacity, Arena* arena) {
+    CARVE(pool, x, capacity, arena);
+    CARVE(pool, y, capacity, arena);
+    CARVE(pool, prevX, capacity, arena);
+    CARVE(pool, prevY, capacity, arena);
+    CARVE(pool, width, capacity, arena);
+    CARVE(pool, height, capacity, arena);
+    CARVE(pool, speed, capacity, arena);
+    CARVE(pool, health, capacity, arena);
+    CARVE(pool, type, capacity, arena);
+    CARVE(pool, active, capacity, arena);
+    CARVE(pool, bulletCooldown, capacity, arena);
+    CARVE(pool, movementPattern, capacity, arena);
+    CARVE(pool, score, capacity, arena);
+    pool->count = 0;
+    pool->capacity = capacity;
+}
+
+void powerupPoolAllocate(PowerupPool* pool, int capacity, Arena* arena) {
+    CARVE(pool, x, capacity, arena);
+    CARVE(pool, y, capacity, arena);
+    CARVE(pool, prevX, capacity, arena);
+    CARVE(pool, prevY, capacity, arena);
+    CARVE(pool, width, capacity, arena);
+    CARVE(pool, height, capacity, arena);
+    CARVE(pool, type, capacity, arena);
+    CARVE(pool, active, capacity, arena);
+    CARVE(pool, speed, capacity, arena);
+    pool->count = 0;
+    pool->capacity = capacity;
+}
+
+void explosionPoolAllocate(ExplosionPool* pool, int capacity, Arena* arena) {
+    CARVE(pool, x, capacity, arena);
+    CARVE(pool, y, capacity, arena);
+    CARVE(pool, width, capacity, arena);
+    CARVE(pool, height, capacity, arena);
+    CARVE(pool, lifespan, capacity, arena);
+    CARVE(pool, currentLife, capacity, arena);
+    CARVE(pool, active, capacity, arena);
+    CARVE(pool, persistent, capacity, arena);
+    CARVE(pool, spawnSequence, capacity, arena);
+    CARVE(pool, recycle, capacity, arena);
+    CARVE(pool, recycleSlot, capacity, arena);
+    pool->count = 0;
+    pool->capacity = capacity;
+    pool->recycleCount = -1;
+}
+
+static void carvePools(GameState* gameState, const GameCapacities* capacities, Arena* arena) {
+    bulletPoolAllocate(&gameState->bullets, capacities->bullets, arena);
+    enemyPoolAllocate(&gameState->enemies, capacities->enemies, arena);
+    bulletPoolAllocate(&gameState->enemyBullets, capacities->enemyBullets, arena);
+    powerupPoolAllocate(&gameState->powerups, capacities->powerups, arena);
+    explosionPoolAllocate(&gameState->explosions, capacities->explosions, arena);
+}
+
+void gameAllocate(GameState* gameState, const GameCapacities* capacities) {
+    Arena measure = { 0 };
+    carvePools(gameState, capacities, &measure);
+    arenaFree(&gameState->storage);
+    arenaInit(&gameState->storage, measure.used);
+    carvePools(gameState, capacities, &gameState->storage);
+}
+
+void gameFree(GameState* gameState) {
+    arenaFree(&gameState->storage);
+    GameCapacities none = { 0 };
+    carvePools(gameState, &none, &gameState->storage);
+}
+
+#define COPY_COLUMN(dst, src, column) \
+    memcpy((dst)->column, (src)->column, sizeof((src)->column[0]) * (size_t)(src)->count)
+
+static void checkCopyFits(int count, int capacity, const char* pool) {
+    if (count > capacity) {
+        printf("Cannot copy %d %s into a pool of %d\n", count, pool, capacity);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void copyBullets(BulletPool* dst, const BulletPool* src) {
+    checkCopyFits(src->count, dst->capacity, "bullets");
+    COPY_COLUMN(dst, src, x);
+    COPY_COLUMN(dst, src, y);
+    COPY_COLUMN(dst, src, prevX);
+    COPY_COLUMN(dst, src, prevY);
+    COPY_COLUMN(dst, src, width);
+    COPY_COLUMN(dst, src, height);
+    COPY_COLUMN(dst, src, speed);
+    COPY_COLUMN(dst, src, active);
+    dst->count = src->count;
+}
+
+static void copyEnemies(EnemyPool* dst, const EnemyPool* src) {
+    checkCopyFits(src->count, dst->capacity, "enemies");
+    COPY_COLUMN(dst, src, x);
+    COPY_COLUMN(dst, src, y);
+    COPY_COLUMN(dst, src, prevX);
+    COPY_COLUMN(dst, src, prevY);
+    COPY_COLUMN(dst, src, width);
+    COPY_COLUMN(dst, src, height);
+    COPY_COLUMN(dst, src, speed);
+    COPY_COLUMN(dst, src, health);
+    COPY_COLUMN(dst, src, type);
+    COPY_COLUMN(dst, src, active);
+    COPY_COLUMN(dst, src, bulletCooldown);
+    COPY_COLUMN(dst, src, movementPattern);
+    COPY_COLUMN(dst, src, score);
+    dst->count = src->count;
+}
+
+static void copyPowerups(PowerupPool* dst, const PowerupPool* src) {
+    checkCopyFits(src->count, dst->capacity, "powerups");
+    COPY_COLUMN(dst, src, x);
+    COPY_COLUMN(dst, src, y);
+    COPY_COLUMN(dst, src, prevX);
+    COPY_COLUMN(dst, src, prevY);
+    COPY_COLUMN(dst, src, width);
+    COPY_COLUMN(dst, src, height);
+    COPY_COLUMN(dst, src, type);
+    COPY_COLUMN(dst, src, active);
+    COPY_COLUMN(dst, src, speed);
+    dst->count = src->count;
+}
+
+static void copyExplosions(ExplosionPool* dst, const ExplosionPool* src) {
+    checkCopyFits(src->count, dst->capacity, "explosions");
+    COPY_COLUMN(dst, src, x);
+    COPY_COLUMN(dst, src, y);
+    COPY_COLUMN(dst, src, width);
+    COPY_COLUMN(dst, src, height);
+    COPY_COLUMN(dst, src, lifespan);
+    COPY_COLUMN(dst, src, currentLife);
+    COPY_COLUMN(dst, src, active);
+    COPY_COLUMN(dst, src, persistent);
+    COPY_COLUMN(dst, src, spawnSequence);
+    dst->count = src->count;
+    dst->recycleCount = -1;
+}
+
+void gameCopy(GameState* dst, const GameState* src) {
+    BulletPool bullets = dst->bullets;
+    EnemyPool enemies = dst->enemies;
+    BulletPool enemyBullets = dst->enemyBullets;
+    PowerupPool powerups = dst->powerups;
+    ExplosionPool explosions = dst->explosions;
+    Arena storage = dst->storage;
+
+    *dst = *src;
+    dst->bullets = bullets;
+    dst->enemies = enemies;
+    dst->enemyBullets = enemyBullets;
+    dst->powerups = powerups;
+    dst->explosions = explosions;
+    dst->storage = storage;
+
+    copyBullets(&dst->bullets, &src->bullets);
+    copyEnemies(&dst->enemies, &src->enemies);
+    copyBullets(&dst->enemyBullets, &src->enemyBullets);
+    copyPowerups(&dst->powerups, &src->powerups);
+    copyExplosions(&dst->explosions, &src->explosions);
+}
+
 void initGame(GameState* gameState) {
+    if (!gameState->storage.base) {
+        GameCapacities capacities;
+        gameCapacitiesDefault(&capacities);
+        gameAllocate(gameState, &capacities);
+    }
+
     gameState->player.x = 50.0f;
     gameState->player.y = SCREEN_HEIGHT / 2.0f;
     gameState->player.width = PLAYER_WIDTH;
@@ -173,37 +548,320 @@ void initGame(GameState* gameState) {
     gameState->enemySpawnTimer = 0.0f;
     gameState->powerupSpawnTimer = 0.0f;
 
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        gameState->bullets[i].active = false;
+    gameState->bullets.count = 0;
+    gameState->enemies.count = 0;
+    gameState->enemyBullets.count = 0;
+    gameState->powerups.count = 0;
+    gameState->explosions.count = 0;
+    gameState->explosions.recycleCount = -1;
+
+    gameSnapInterpolation(gameState);
+
+    gameState->gameOver = false;
+    gameState->paused = false;
+    gameState->benchmarkMode = false;
+    gameState->benchmarkSpawnBand = 0.10f;
+    gameState->broadPhase = BROADPHASE_GRID;
+    gameState->verifyBroadPhase = false;
+    gameState->broadPhaseMismatches = 0;
+}
+
+typedef struct {
+    GameState* gameState;
+    float deltaTime;
+} SimJob;
+
+typedef struct {
+    BulletPool* pool;
+    float scale;
+    unsigned cull;
+} ProjectileJob;
+
+static void integrateProjectileRange(void* ctx, int begin, int end) {
+    ProjectileJob* job = ctx;
+    BulletPool* pool = job->pool;
+    TRACE_BEGIN("projectile chunk");
+    chunkCulled[begin / SIM_GRAIN] =
+        integrateProjectiles(pool->x + begin, pool->y + begin, pool->speed + begin,
+                             pool->width + begin, pool->height + begin, end - begin,
+                             job->scale, SCREEN_WIDTH, SCREEN_HEIGHT, job->cull, culledIndices + begin);
+    TRACE_END();
+}
+
+// Integrates a projectile pool in parallel and gathers the per-chunk cull
+// lists into culledIndices, ascending. Returns how many were culled.
+static int integrateProjectilesParallel(BulletPool* pool, float scale, unsigned cull) {
+    culledIndices = frameScratch(sizeof(int) * (size_t)pool->count);
+    chunkCulled = frameScratch(sizeof(int) * (size_t)CHUNKS(pool->count, SIM_GRAIN));
+    ProjectileJob job = { pool, scale, cull };
+    jobsParallelFor(pool->count, SIM_GRAIN, integrateProjectileRange, &job);
+
+    // Slices only ever move towards the front, so this can compact in place.
+    int total = 0;
+    for (int begin = 0; begin < pool->count; begin += SIM_GRAIN) {
+        int culled = chunkCulled[begin / SIM_GRAIN];
+        for (int k = 0; k < culled; k++) {
+            culledIndices[total++] = begin + culledIndices[begin + k];
+        }
     }
+    return total;
+}
 
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        gameState->enemies[i].active = false;
+// Counts down the medium retarget timer or the large/boss fire cooldown.
+// Returns true when it expired and runEnemyBehaviour has to run.
+static bool tickEnemyTimers(EnemyPool* enemies, int i, float deltaTime) {
+    switch (enemies->type[i]) {
+        case ENEMY_MEDIUM:
+            enemies->movementPattern[i] -= deltaTime;
+            return enemies->movementPattern[i] <= 0;
+        case ENEMY_LARGE:
+        case ENEMY_BOSS:
+            enemies->bulletCooldown[i] -= deltaTime;
+            return enemies->bulletCooldown[i] <= 0;
+        default:
+            return false;
     }
+}
 
-    for (int i = 0; i < MAX_ENEMY_BULLETS; i++) {
-        gameState->enemyBullets[i].active = false;
+static void runEnemyBehaviour(GameState* gameState, int i) {
+    switch (gameState->enemies.type[i]) {
+        case ENEMY_SMALL:
+            break;
+        case ENEMY_MEDIUM:
+            if ((rng_u32() & 1u) != 0u) {
+                gameState->enemies.speed[i] = fabs(gameState->enemies.speed[i]);
+            } else {
+                gameState->enemies.speed[i] = -fabs(gameState->enemies.speed[i]);
+            }
+            gameState->enemies.movementPattern[i] = (float)rng_range(3u) + 1.0f;
+            break;
+        case ENEMY_LARGE: {
+            int j = POOL_ACQUIRE(gameState->enemyBullets);
+            if (j >= 0) {
+                float bulletY = gameState->enemies.y[i];
+                
+                if (bulletY < BULLET_HEIGHT/2) {
+                    bulletY = BULLET_HEIGHT/2;
+                } else if (bulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
+                    bulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
+                }
+                
+                gameState->enemyBullets.x[j] = gameState->enemies.x[i] - BULLET_WIDTH;
+                gameState->enemyBullets.y[j] = bulletY;
+                gameState->enemyBullets.width[j] = BULLET_WIDTH;
+                gameState->enemyBullets.height[j] = BULLET_HEIGHT;
+                gameState->enemyBullets.speed[j] = ENEMY_BULLET_SPEED;
+                SNAP_PREVIOUS(gameState->enemyBullets, j);
+                gameState->enemies.bulletCooldown[i] = 2.0f;
+            }
+            break;
+        }
+        case ENEMY_BOSS:
+            for (int b = 0; b < 3; b++) {
+                int j = POOL_ACQUIRE(gameState->enemyBullets);
+                if (j < 0) {
+                    break;
+                }
+
+                float bulletY = gameState->enemies.y[i] + (b - 1) * 20.0f;
+                
+                if (bulletY < BULLET_HEIGHT/2) {
+                    bulletY = BULLET_HEIGHT/2;
+                } else if (bulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
+                    bulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
+                }
+                
+                gameState->enemyBullets.x[j] = gameState->enemies.x[i] - BULLET_WIDTH;
+                gameState->enemyBullets.y[j] = bulletY;
+                gameState->enemyBullets.width[j] = BULLET_WIDTH;
+                gameState->enemyBullets.height[j] = BULLET_HEIGHT;
+                gameState->enemyBullets.speed[j] = ENEMY_BULLET_SPEED;
+                SNAP_PREVIOUS(gameState->enemyBullets, j);
+            }
+            gameState->enemies.bulletCooldown[i] = 1.0f;
+            break;
     }
+}
 
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        gameState->powerups[i].active = false;
+static void moveEnemyVertically(EnemyPool* enemies, int i, float deltaTime) {
+    if (enemies->type[i] == ENEMY_MEDIUM) {
+        enemies->y[i] += enemies->speed[i] * 0.3f * deltaTime;
     }
+}
 
-    for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-        gameState->explosions[i].active = false;
-        gameState->explosions[i].persistent = false;
+// Clamps the enemy to the playfield and despawns it once it has left on the
+// left. Returns true when it left in benchmark mode and wrapEnemy has to run.
+MODE_INLINE bool settleEnemy(const bool bench, GameState* gameState, int i) {
+    if (gameState->enemies.y[i] < gameState->enemies.height[i] / 2) {
+        gameState->enemies.y[i] = gameState->enemies.height[i] / 2;
+        if (gameState->enemies.type[i] == ENEMY_MEDIUM) {
+            gameState->enemies.speed[i] = fabs(gameState->enemies.speed[i]);
+        }
+    } else if (gameState->enemies.y[i] > SCREEN_HEIGHT - gameState->enemies.height[i]) {
+        gameState->enemies.y[i] = SCREEN_HEIGHT - gameState->enemies.height[i];
+        if (gameState->enemies.type[i] == ENEMY_MEDIUM) {
+            gameState->enemies.speed[i] = -fabs(gameState->enemies.speed[i]);
+        }
+    }
+    
+    if (!bench && gameState->enemies.type[i] == ENEMY_BOSS) {
+        if (gameState->enemies.x[i] < SCREEN_WIDTH / 2) {
+            gameState->enemies.x[i] = SCREEN_WIDTH / 2;
+        } else if (gameState->enemies.x[i] > SCREEN_WIDTH - gameState->enemies.width[i] / 2) {
+            gameState->enemies.x[i] = SCREEN_WIDTH - gameState->enemies.width[i] / 2;
+        }
     }
+    
+    if (!bench) {
+        if (gameState->enemies.x[i] < -gameState->enemies.width[i] && 
+            gameState->enemies.type[i] != ENEMY_BOSS) {
+            POOL_RELEASE(gameState->enemies, i);
+        }
+        return false;
+    }
+    return gameState->enemies.x[i] < -gameState->enemies.width[i] * 0.25f;
+}
 
-    gameState->gameOver = false;
-    gameState->paused = false;
-    gameState->benchmarkMode = false;
-    gameState->benchmarkSpawnBand = 0.10f;
+static void wrapEnemy(GameState* gameState, int i) {
+    float enemyHeight = gameState->enemies.height[i];
+    float minY = enemyHeight / 2.0f;
+    float maxY = SCREEN_HEIGHT - enemyHeight;
+    float bandFrac = gameState->benchmarkSpawnBand;
+    if (bandFrac <= 0.0f) bandFrac = 0.10f;
+    if (bandFrac > 1.0f) bandFrac = 1.0f;
+    float band = SCREEN_WIDTH * bandFrac;
+    float jitter = (float)rng_range((uint32_t)(band + 1.0f));
+    gameState->enemies.x[i] = (SCREEN_WIDTH - gameState->enemies.width[i] / 2.0f) - jitter;
+    gameState->enemies.y[i] = minY + (float)rng_range((uint32_t)(maxY - minY + 1.0f));
+    SNAP_PREVIOUS(gameState->enemies, i);
+    gameState->enemies.movementPattern[i] = (float)rng_range(628u) / 100.0f;
+    if (gameState->enemies.type[i] == ENEMY_LARGE || gameState->enemies.type[i] == ENEMY_BOSS) {
+        gameState->enemies.bulletCooldown[i] = (float)rng_range(3u) * 0.5f + 0.2f;
+    }
 }
 
-void updateGame(GameState* gameState, float deltaTime) {
-    if (gameState->gameOver || gameState->paused) {
-        return;
+MODE_INLINE void updateEnemyRangeMode(const bool bench, void* ctx, int begin, int end) {
+    SimJob* job = ctx;
+    EnemyPool* enemies = &job->gameState->enemies;
+    TRACE_BEGIN("enemy chunk");
+
+    // Drift, small-enemy wobble and boss sweep run as one vectorized pass.
+    updateEnemyMotion(enemies, begin, end, job->deltaTime, SCREEN_HEIGHT);
+
+    for (int i = begin; i < end; i++) {
+        if (tickEnemyTimers(enemies, i, job->deltaTime)) {
+            enemyEvents[i] = ENEMY_EVENT_BEHAVIOUR;
+            continue;
+        }
+        moveEnemyVertically(enemies, i, job->deltaTime);
+        enemyEvents[i] = settleEnemy(bench, job->gameState, i) ? ENEMY_EVENT_WRAP : ENEMY_EVENT_NONE;
+    }
+    TRACE_END();
+}
+MODE_INSTANCES(updateEnemyRange, (void* ctx, int begin, int end), ctx, begin, end)
+
+// Branch-free so it can vectorize: the clamp is a pair of selects and
+// leaving on the left only sets a flag, which play turns into a release. The
+// pool is packed here, so every entry in range starts out active.
+MODE_INLINE void updatePowerupRangeMode(const bool bench, void* ctx, int begin, int end) {
+    SimJob* job = ctx;
+    PowerupPool* powerups = &job->gameState->powerups;
+    float deltaTime = job->deltaTime;
+
+    for (int i = begin; i < end; i++) {
+        float x = powerups->x[i] - powerups->speed[i] * deltaTime;
+        float y = powerups->y[i];
+        float minY = powerups->height[i] / 2;
+        float maxY = SCREEN_HEIGHT - powerups->height[i];
+        y = y > maxY ? maxY : y;
+        y = y < minY ? minY : y;
+        bool gone = x < -powerups->width[i];
+
+        powerups->x[i] = x;
+        powerups->y[i] = y;
+        if (bench) {
+            powerupWrapPending[i] = gone;
+        } else {
+            powerups->active[i] = !gone;
+        }
+    }
+}
+MODE_INSTANCES(updatePowerupRange, (void* ctx, int begin, int end), ctx, begin, end)
+
+// Persistent explosions loop back to full life in benchmark mode; every
+// other one is released once its life runs out. Packed, like the powerups.
+MODE_INLINE void updateExplosionRangeMode(const bool bench, void* ctx, int begin, int end) {
+    SimJob* job = ctx;
+    ExplosionPool* explosions = &job->gameState->explosions;
+    float deltaTime = job->deltaTime;
+
+    for (int i = begin; i < end; i++) {
+        float life = explosions->currentLife[i] - deltaTime;
+        bool expired = life <= 0;
+        if (bench) {
+            bool persistent = explosions->persistent[i];
+            float lifespan = explosions->lifespan[i];
+            explosions->currentLife[i] = expired & persistent ? lifespan : life;
+            explosions->active[i] = !expired | persistent;
+        } else {
+            explosions->currentLife[i] = life;
+            explosions->active[i] = !expired;
+        }
+    }
+}
+MODE_INSTANCES(updateExplosionRange, (void* ctx, int begin, int end), ctx, begin, end)
+
+static void snapPositions(float* prevX, float* prevY, const float* x, const float* y, int count) {
+    memcpy(prevX, x, sizeof(float) * (size_t)count);
+    memcpy(prevY, y, sizeof(float) * (size_t)count);
+}
+
+void gameSnapInterpolation(GameState* gameState) {
+    BulletPool* bullets = &gameState->bullets;
+    BulletPool* enemyBullets = &gameState->enemyBullets;
+    EnemyPool* enemies = &gameState->enemies;
+    PowerupPool* powerups = &gameState->powerups;
+    snapPositions(bullets->prevX, bullets->prevY, bullets->x, bullets->y, bullets->count);
+    snapPositions(enemyBullets->prevX, enemyBullets->prevY, enemyBullets->x, enemyBullets->y,
+                  enemyBullets->count);
+    snapPositions(enemies->prevX, enemies->prevY, enemies->x, enemies->y, enemies->count);
+    snapPositions(powerups->prevX, powerups->prevY, powerups->x, powerups->y, powerups->count);
+
+    gameState->player.prevX = gameState->player.x;
+    gameState->player.prevY = gameState->player.y;
+
+    Level* level = &gameState->level;
+    level->prevBackgroundOffset = level->backgroundOffset;
+    level->prevMidgroundOffset = level->midgroundOffset;
+    level->prevForegroundOffset = level->foregroundOffset;
+}
+
+MODE_INLINE void updateEnemiesMode(const bool bench, GameState* gameState, float deltaTime) {
+    SimJob job = { gameState, deltaTime };
+
+    TRACE_BEGIN("enemies");
+    enemyEvents = frameScratch(sizeof(unsigned char) * (size_t)gameState->enemies.count);
+    jobsParallelFor(gameState->enemies.count, SIM_GRAIN, bench ? updateEnemyRangeBench : updateEnemyRangePlay,
+                    &job);
+    for (int i = 0; i < gameState->enemies.count; i++) {
+        if (enemyEvents[i] == ENEMY_EVENT_BEHAVIOUR) {
+            runEnemyBehaviour(gameState, i);
+            moveEnemyVertically(&gameState->enemies, i, deltaTime);
+            if (settleEnemy(bench, gameState, i)) {
+                wrapEnemy(gameState, i);
+            }
+        } else if (enemyEvents[i] == ENEMY_EVENT_WRAP) {
+            wrapEnemy(gameState, i);
+        }
     }
+    compactEnemies(&gameState->enemies);
+    TRACE_END();
+}
+MODE_INSTANCES(updateEnemies, (GameState* gameState, float deltaTime), gameState, deltaTime)
+
+MODE_INLINE void updateGameMode(const bool bench, GameState* gameState, float deltaTime) {
+    TRACE_BEGIN("updateGame");
+    beginFrame();
 
     float diagonalFactor = 0.7071f; 
     
@@ -264,250 +922,119 @@ void updateGame(GameState* gameState, float deltaTime) {
         }
     }
 
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (gameState->bullets[i].active) {
-            gameState->bullets[i].x += gameState->bullets[i].speed * deltaTime;
-
-            if (gameState->benchmarkMode) {
-                float offLeft = -gameState->bullets[i].width;
-                float offRight = SCREEN_WIDTH + gameState->bullets[i].width;
-                if (gameState->bullets[i].speed < 0.0f && gameState->bullets[i].x < offLeft) {
-                    gameState->bullets[i].x = SCREEN_WIDTH - gameState->bullets[i].width / 2.0f;
-                    float minY = BULLET_HEIGHT / 2.0f;
-                    float maxY = SCREEN_HEIGHT - BULLET_HEIGHT;
-                    gameState->bullets[i].y = minY + (float)(rng_u32() % (uint32_t)(maxY - minY + 1.0f));
-                } else if (gameState->bullets[i].speed > 0.0f && gameState->bullets[i].x > offRight) {
-                    gameState->bullets[i].x = gameState->bullets[i].width / 2.0f;
-                    float minY = BULLET_HEIGHT / 2.0f;
-                    float maxY = SCREEN_HEIGHT - BULLET_HEIGHT;
-                    gameState->bullets[i].y = minY + (float)(rng_u32() % (uint32_t)(maxY - minY + 1.0f));
-                }
-            } else {
-                if (gameState->bullets[i].x > SCREEN_WIDTH + gameState->bullets[i].width) {
-                    gameState->bullets[i].active = false;
-                }
-                if (gameState->bullets[i].y < -gameState->bullets[i].height || 
-                    gameState->bullets[i].y > SCREEN_HEIGHT + gameState->bullets[i].height) {
-                    gameState->bullets[i].active = false;
-                }
-            }
+    // Projectiles are integrated and culled by the vectorized kernel; only
+    // the ones that left the playfield come back here to be killed, or
+    // wrapped to the opposite edge in benchmark mode.
+    TRACE_BEGIN("bullets");
+    {
+        BulletPool* bullets = &gameState->bullets;
+        unsigned cull = bench ? (CULL_LEFT | CULL_RIGHT) : (CULL_RIGHT | CULL_VERTICAL);
+        int culled = integrateProjectilesParallel(bullets, deltaTime, cull);
+        float minY = BULLET_HEIGHT / 2.0f;
+        float maxY = SCREEN_HEIGHT - BULLET_HEIGHT;
+        // Bounded draws for the wraps, filled in bulk before the loop. Entry
+        // k belongs to culledIndices[k].
+        uint32_t* wrapDraws = NULL;
+        if (bench) {
+            wrapDraws = frameScratch(sizeof(uint32_t) * (size_t)culled);
+            rng_fill_range(wrapDraws, culled, (uint32_t)(maxY - minY + 1.0f));
         }
-    }
-
-    for (int i = 0; i < MAX_ENEMY_BULLETS; i++) {
-        if (gameState->enemyBullets[i].active) {
-            gameState->enemyBullets[i].x -= gameState->enemyBullets[i].speed * deltaTime;
 
-            if (gameState->benchmarkMode) {
-                if (gameState->enemyBullets[i].x < -gameState->enemyBullets[i].width) {
-                    gameState->enemyBullets[i].x = SCREEN_WIDTH - gameState->enemyBullets[i].width / 2.0f;
-                    float minY = BULLET_HEIGHT / 2.0f;
-                    float maxY = SCREEN_HEIGHT - BULLET_HEIGHT;
-                    gameState->enemyBullets[i].y = minY + (float)(rng_u32() % (uint32_t)(maxY - minY + 1.0f));
+        for (int k = 0; k < culled; k++) {
+            int i = culledIndices[k];
+            if (bench) {
+                float offLeft = -bullets->width[i];
+                float offRight = SCREEN_WIDTH + bullets->width[i];
+                if (bullets->speed[i] < 0.0f && bullets->x[i] < offLeft) {
+                    bullets->x[i] = SCREEN_WIDTH - bullets->width[i] / 2.0f;
+                    bullets->y[i] = minY + (float)wrapDraws[k];
+                    SNAP_PREVIOUS(*bullets, i);
+                } else if (bullets->speed[i] > 0.0f && bullets->x[i] > offRight) {
+                    bullets->x[i] = bullets->width[i] / 2.0f;
+                    bullets->y[i] = minY + (float)wrapDraws[k];
+                    SNAP_PREVIOUS(*bullets, i);
                 }
             } else {
-                if (gameState->enemyBullets[i].x < -gameState->enemyBullets[i].width) {
-                    gameState->enemyBullets[i].active = false;
-                }
-                if (gameState->enemyBullets[i].y < -gameState->enemyBullets[i].height || 
-                    gameState->enemyBullets[i].y > SCREEN_HEIGHT + gameState->enemyBullets[i].height) {
-                    gameState->enemyBullets[i].active = false;
-                }
+                POOL_RELEASE(*bullets, i);
             }
         }
+        compactBullets(bullets);
     }
+    TRACE_END();
 
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (gameState->enemies[i].active) {
-            gameState->enemies[i].x -= gameState->enemies[i].speed * deltaTime;
-            
-            switch (gameState->enemies[i].type) {
-                case ENEMY_SMALL:
-                    gameState->enemies[i].movementPattern += 3.0f * deltaTime;
-                    gameState->enemies[i].y += sinf(gameState->enemies[i].movementPattern) * 1.5f;
-                    break;
-                case ENEMY_MEDIUM:
-                    gameState->enemies[i].movementPattern -= deltaTime;
-                    if (gameState->enemies[i].movementPattern <= 0) {
-                        if ((rng_u32() & 1u) != 0u) {
-                            gameState->enemies[i].speed = fabs(gameState->enemies[i].speed);
-                        } else {
-                            gameState->enemies[i].speed = -fabs(gameState->enemies[i].speed);
-                        }
-                        gameState->enemies[i].movementPattern = (float)(rng_u32() % 3u) + 1.0f;
-                    }
-                    gameState->enemies[i].y += gameState->enemies[i].speed * 0.3f * deltaTime;
-                    break;
-                case ENEMY_LARGE:
-                    gameState->enemies[i].bulletCooldown -= deltaTime;
-                    if (gameState->enemies[i].bulletCooldown <= 0) {
-                        for (int j = 0; j < MAX_ENEMY_BULLETS; j++) {
-                            if (!gameState->enemyBullets[j].active) {
-                                float bulletY = gameState->enemies[i].y;
-                                
-                                if (bulletY < BULLET_HEIGHT/2) {
-                                    bulletY = BULLET_HEIGHT/2;
-                                } else if (bulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
-                                    bulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
-                                }
-                                
-                                gameState->enemyBullets[j].x = gameState->enemies[i].x - gameState->enemyBullets[j].width;
-                                gameState->enemyBullets[j].y = bulletY;
-                                gameState->enemyBullets[j].width = BULLET_WIDTH;
-                                gameState->enemyBullets[j].height = BULLET_HEIGHT;
-                                gameState->enemyBullets[j].speed = ENEMY_BULLET_SPEED;
-                                gameState->enemyBullets[j].active = true;
-                                gameState->enemies[i].bulletCooldown = 2.0f;
-                                break;
-                            }
-                        }
-                    }
-                    break;
-                case ENEMY_BOSS:
-                    gameState->enemies[i].movementPattern += deltaTime;
-                    
-                    float newY = SCREEN_HEIGHT / 2 + sinf(gameState->enemies[i].movementPattern) * (SCREEN_HEIGHT / 3);
-                    
-                    if (newY < gameState->enemies[i].height / 2) {
-                        newY = gameState->enemies[i].height / 2;
-                    } else if (newY > SCREEN_HEIGHT - gameState->enemies[i].height) {
-                        newY = SCREEN_HEIGHT - gameState->enemies[i].height;
-                    }
-                    
-                    gameState->enemies[i].y = newY;
-                    
-                    gameState->enemies[i].bulletCooldown -= deltaTime;
-                    if (gameState->enemies[i].bulletCooldown <= 0) {
-                        for (int b = 0; b < 3; b++) {
-                            for (int j = 0; j < MAX_ENEMY_BULLETS; j++) {
-                                if (!gameState->enemyBullets[j].active) {
-                                    float bulletY = gameState->enemies[i].y + (b - 1) * 20.0f;
-                                    
-                                    if (bulletY < BULLET_HEIGHT/2) {
-                                        bulletY = BULLET_HEIGHT/2;
-                                    } else if (bulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
-                                        bulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
-                                    }
-                                    
-                                    gameState->enemyBullets[j].x = gameState->enemies[i].x - gameState->enemyBullets[j].width;
-                                    gameState->enemyBullets[j].y = bulletY;
-                                    gameState->enemyBullets[j].width = BULLET_WIDTH;
-                                    gameState->enemyBullets[j].height = BULLET_HEIGHT;
-                                    gameState->enemyBullets[j].speed = ENEMY_BULLET_SPEED;
-                                    gameState->enemyBullets[j].active = true;
-                                    break;
-                                }
-                            }
-                        }
-                        gameState->enemies[i].bulletCooldown = 1.0f;
-                    }
-                    break;
-            }
-            
-            if (gameState->enemies[i].y < gameState->enemies[i].height / 2) {
-                gameState->enemies[i].y = gameState->enemies[i].height / 2;
-                if (gameState->enemies[i].type == ENEMY_MEDIUM) {
-                    gameState->enemies[i].speed = fabs(gameState->enemies[i].speed);
-                }
-            } else if (gameState->enemies[i].y > SCREEN_HEIGHT - gameState->enemies[i].height) {
-                gameState->enemies[i].y = SCREEN_HEIGHT - gameState->enemies[i].height;
-                if (gameState->enemies[i].type == ENEMY_MEDIUM) {
-                    gameState->enemies[i].speed = -fabs(gameState->enemies[i].speed);
-                }
-            }
-            
-            if (gameState->enemies[i].type == ENEMY_BOSS) {
-                if (!gameState->benchmarkMode) {
-                    if (gameState->enemies[i].x < SCREEN_WIDTH / 2) {
-                        gameState->enemies[i].x = SCREEN_WIDTH / 2;
-                    } else if (gameState->enemies[i].x > SCREEN_WIDTH - gameState->enemies[i].width / 2) {
-                        gameState->enemies[i].x = SCREEN_WIDTH - gameState->enemies[i].width / 2;
-                    }
-                }
-            }
-            
-            if (!gameState->benchmarkMode) {
-                if (gameState->enemies[i].x < -gameState->enemies[i].width && 
-                    gameState->enemies[i].type != ENEMY_BOSS) {
-                    gameState->enemies[i].active = false;
-                }
-            } else {
-                float wrapThreshold = -gameState->enemies[i].width * 0.25f;
-                if (gameState->enemies[i].x < wrapThreshold) {
-                    float enemyHeight = gameState->enemies[i].height;
-                    float minY = enemyHeight / 2.0f;
-                    float maxY = SCREEN_HEIGHT - enemyHeight;
-                    float bandFrac = gameState->benchmarkSpawnBand;
-                    if (bandFrac <= 0.0f) bandFrac = 0.10f;
-                    if (bandFrac > 1.0f) bandFrac = 1.0f;
-                    float band = SCREEN_WIDTH * bandFrac;
-                    float jitter = (float)(rng_u32() % (uint32_t)(band + 1.0f));
-                    gameState->enemies[i].x = (SCREEN_WIDTH - gameState->enemies[i].width / 2.0f) - jitter;
-                    gameState->enemies[i].y = minY + (float)(rng_u32() % (uint32_t)(maxY - minY + 1.0f));
-                    gameState->enemies[i].movementPattern = (float)(rng_u32() % 628u) / 100.0f;
-                    if (gameState->enemies[i].type == ENEMY_LARGE || gameState->enemies[i].type == ENEMY_BOSS) {
-                        gameState->enemies[i].bulletCooldown = (float)(rng_u32() % 3u) * 0.5f + 0.2f;
-                    }
-                }
-            }
+    TRACE_BEGIN("enemyBullets");
+    {
+        BulletPool* enemyBullets = &gameState->enemyBullets;
+        unsigned cull = bench ? CULL_LEFT : (CULL_LEFT | CULL_VERTICAL);
+        int culled = integrateProjectilesParallel(enemyBullets, -deltaTime, cull);
+        float minY = BULLET_HEIGHT / 2.0f;
+        float maxY = SCREEN_HEIGHT - BULLET_HEIGHT;
+        uint32_t* wrapDraws = NULL;
+        if (bench) {
+            wrapDraws = frameScratch(sizeof(uint32_t) * (size_t)culled);
+            rng_fill_range(wrapDraws, culled, (uint32_t)(maxY - minY + 1.0f));
         }
-    }
 
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (gameState->powerups[i].active) {
-            gameState->powerups[i].x -= gameState->powerups[i].speed * deltaTime;
-            
-            if (gameState->powerups[i].y < gameState->powerups[i].height / 2) {
-                gameState->powerups[i].y = gameState->powerups[i].height / 2;
-            } else if (gameState->powerups[i].y > SCREEN_HEIGHT - gameState->powerups[i].height) {
-                gameState->powerups[i].y = SCREEN_HEIGHT - gameState->powerups[i].height;
-            }
-            
-            if (!gameState->benchmarkMode) {
-                if (gameState->powerups[i].x < -gameState->powerups[i].width) {
-                    gameState->powerups[i].active = false;
-                }
+        for (int k = 0; k < culled; k++) {
+            int i = culledIndices[k];
+            if (bench) {
+                enemyBullets->x[i] = SCREEN_WIDTH - enemyBullets->width[i] / 2.0f;
+                enemyBullets->y[i] = minY + (float)wrapDraws[k];
+                SNAP_PREVIOUS(*enemyBullets, i);
             } else {
-                if (gameState->powerups[i].x < -gameState->powerups[i].width) {
-                    gameState->powerups[i].x = SCREEN_WIDTH - gameState->powerups[i].width / 2.0f;
-                    float minY = gameState->powerups[i].height / 2.0f;
-                    float maxY = SCREEN_HEIGHT - gameState->powerups[i].height;
-                    gameState->powerups[i].y = minY + (float)(rng_u32() % (uint32_t)(maxY - minY + 1.0f));
-                    gameState->powerups[i].type = (PowerupType)(rng_u32() % 3u);
-                }
+                POOL_RELEASE(*enemyBullets, i);
             }
         }
+        compactBullets(enemyBullets);
     }
+    TRACE_END();
 
-    for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-        if (gameState->explosions[i].active) {
-            gameState->explosions[i].currentLife -= deltaTime;
-            if (gameState->explosions[i].currentLife <= 0) {
-                if (gameState->benchmarkMode && gameState->explosions[i].persistent) {
-                    gameState->explosions[i].currentLife = gameState->explosions[i].lifespan;
-                } else {
-                    gameState->explosions[i].active = false;
-                }
-            }
+    // Per-pool updates run in parallel chunks. Anything that draws from the
+    // RNG or appends to a pool is only flagged there and then replayed here in
+    // index order, so the outcome does not depend on the thread count.
+    SimJob job = { gameState, deltaTime };
+
+    if (bench) {
+        updateEnemiesBench(gameState, deltaTime);
+    } else {
+        updateEnemiesPlay(gameState, deltaTime);
+    }
+
+    TRACE_BEGIN("powerups");
+    // Only benchmark mode flags wraps; play releases in the parallel pass.
+    if (bench) {
+        powerupWrapPending = frameScratch(sizeof(bool) * (size_t)gameState->powerups.count);
+    }
+    jobsParallelFor(gameState->powerups.count, SIM_GRAIN, bench ? updatePowerupRangeBench : updatePowerupRangePlay,
+                    &job);
+    for (int i = 0; bench && i < gameState->powerups.count; i++) {
+        if (powerupWrapPending[i]) {
+            gameState->powerups.x[i] = SCREEN_WIDTH - gameState->powerups.width[i] / 2.0f;
+            float minY = gameState->powerups.height[i] / 2.0f;
+            float maxY = SCREEN_HEIGHT - gameState->powerups.height[i];
+            gameState->powerups.y[i] = minY + (float)rng_range((uint32_t)(maxY - minY + 1.0f));
+            SNAP_PREVIOUS(gameState->powerups, i);
+            gameState->powerups.type[i] = (PowerupType)rng_range(3u);
         }
     }
+    compactPowerups(&gameState->powerups);
+    TRACE_END();
 
-    if (!gameState->benchmarkMode) {
+    TRACE_BEGIN("explosions");
+    jobsParallelFor(gameState->explosions.count, SIM_GRAIN,
+                    bench ? updateExplosionRangeBench : updateExplosionRangePlay, &job);
+    compactExplosions(&gameState->explosions);
+    TRACE_END();
+
+    if (!bench) {
         gameState->enemySpawnTimer -= deltaTime;
         if (gameState->enemySpawnTimer <= 0 && !gameState->level.bossSpawned) {
-            int enemyCount = 0;
-            for (int i = 0; i < MAX_ENEMIES; i++) {
-                if (gameState->enemies[i].active) {
-                    enemyCount++;
-                }
-            }
-            
             if (gameState->player.score >= gameState->level.number * 10) {
                 spawnBoss(gameState);
                 gameState->level.bossSpawned = true;
             } else {
                 EnemyType type;
-                int r = (int)(rng_u32() % 100u);
+                int r = (int)rng_range(100u);
                 if (r < 60) {
                     type = ENEMY_SMALL;
                 } else if (r < 85) {
@@ -522,14 +1049,14 @@ void updateGame(GameState* gameState, float deltaTime) {
         }
     }
 
-    if (!gameState->benchmarkMode) {
+    if (!bench) {
         gameState->powerupSpawnTimer -= deltaTime;
         if (gameState->powerupSpawnTimer <= 0) {
             float x = SCREEN_WIDTH;
             
             float minY = POWERUP_HEIGHT / 2;
             float maxY = SCREEN_HEIGHT - POWERUP_HEIGHT;
-            float y = (float)(rng_u32() % (uint32_t)(maxY - minY)) + minY;
+            float y = (float)rng_range((uint32_t)(maxY - minY)) + minY;
             
             spawnPowerup(gameState, x, y);
             gameState->powerupSpawnTimer = POWERUP_SPAWN_DELAY;
@@ -540,15 +1067,46 @@ void updateGame(GameState* gameState, float deltaTime) {
     gameState->level.midgroundOffset += gameState->level.scrollSpeed * 0.7f * deltaTime;   
     gameState->level.foregroundOffset += gameState->level.scrollSpeed * 1.4f * deltaTime;  
 
-    handleCollisions(gameState);
+    if (bench) {
+        handleCollisionsBench(gameState);
+    } else {
+        handleCollisionsPlay(gameState);
+    }
 
     if (gameState->level.bossSpawned && gameState->level.bossDefeated) {
         nextLevel(gameState);
     }
 
-    if (!gameState->benchmarkMode && gameState->player.lives <= 0) {
+    if (!bench && gameState->player.lives <= 0) {
         gameState->gameOver = true;
     }
+
+    TRACE_END();
+}
+MODE_INSTANCES(updateGame, (GameState* gameState, float deltaTime), gameState, deltaTime)
+
+void updateGame(GameState* gameState, float deltaTime) {
+    // Whatever is drawn between this tick and the next blends from where
+    // everything is now. A skipped tick moves nothing, so nothing blends.
+    gameSnapInterpolation(gameState);
+    if (gameState->gameOver || gameState->paused) {
+        return;
+    }
+
+    if (gameState->benchmarkMode) {
+        updateGameBench(gameState, deltaTime);
+    } else {
+        updateGamePlay(gameState, deltaTime);
+    }
+}
+
+void updateEnemies(GameState* gameState, float deltaTime) {
+    beginFrame();
+    if (gameState->benchmarkMode) {
+        updateEnemiesBench(gameState, deltaTime);
+    } else {
+        updateEnemiesPlay(gameState, deltaTime);
+    }
 }
 
 void fireBullet(GameState* gameState) {
@@ -558,210 +1116,196 @@ void fireBullet(GameState* gameState) {
     
     gameState->player.bulletCooldown = gameState->player.isRapidFire ? RAPID_FIRE_COOLDOWN : BULLET_COOLDOWN;
     
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (!gameState->bullets[i].active) {
-            float bulletY = gameState->player.y;
+    int i = POOL_ACQUIRE(gameState->bullets);
+    if (i < 0) {
+        return;
+    }
+
+    float bulletY = gameState->player.y;
+    
+    if (bulletY < BULLET_HEIGHT/2) {
+        bulletY = BULLET_HEIGHT/2;
+    } else if (bulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
+        bulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
+    }
+    
+    gameState->bullets.x[i] = gameState->player.x + gameState->player.width / 2;
+    gameState->bullets.y[i] = bulletY;
+    gameState->bullets.width[i] = BULLET_WIDTH;
+    gameState->bullets.height[i] = BULLET_HEIGHT;
+    gameState->bullets.speed[i] = BULLET_SPEED;
+    SNAP_PREVIOUS(gameState->bullets, i);
+    
+    if (gameState->player.isDoubleBullet) {
+        int j = POOL_ACQUIRE(gameState->bullets);
+        if (j >= 0) {
+            float secondBulletY = gameState->player.y - 10;
             
-            if (bulletY < BULLET_HEIGHT/2) {
-                bulletY = BULLET_HEIGHT/2;
-            } else if (bulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
-                bulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
+            if (secondBulletY < BULLET_HEIGHT/2) {
+                secondBulletY = BULLET_HEIGHT/2;
+            } else if (secondBulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
+                secondBulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
             }
             
-            gameState->bullets[i].x = gameState->player.x + gameState->player.width / 2;
-            gameState->bullets[i].y = bulletY;
-            gameState->bullets[i].width = BULLET_WIDTH;
-            gameState->bullets[i].height = BULLET_HEIGHT;
-            gameState->bullets[i].speed = BULLET_SPEED;
-            gameState->bullets[i].active = true;
-            
-            if (gameState->player.isDoubleBullet) {
-                for (int j = i + 1; j < MAX_BULLETS; j++) {
-                    if (!gameState->bullets[j].active) {
-                        float secondBulletY = gameState->player.y - 10;
-                        
-                        if (secondBulletY < BULLET_HEIGHT/2) {
-                            secondBulletY = BULLET_HEIGHT/2;
-                        } else if (secondBulletY > SCREEN_HEIGHT - BULLET_HEIGHT) {
-                            secondBulletY = SCREEN_HEIGHT - BULLET_HEIGHT;
-                        }
-                        
-                        gameState->bullets[j].x = gameState->player.x + gameState->player.width / 2;
-                        gameState->bullets[j].y = secondBulletY;
-                        gameState->bullets[j].width = BULLET_WIDTH;
-                        gameState->bullets[j].height = BULLET_HEIGHT;
-                        gameState->bullets[j].speed = BULLET_SPEED;
-                        gameState->bullets[j].active = true;
-                        break;
-                    }
-                }
-            }
-            break;
+            gameState->bullets.x[j] = gameState->player.x + gameState->player.width / 2;
+            gameState->bullets.y[j] = secondBulletY;
+            gameState->bullets.width[j] = BULLET_WIDTH;
+            gameState->bullets.height[j] = BULLET_HEIGHT;
+            gameState->bullets.speed[j] = BULLET_SPEED;
+            SNAP_PREVIOUS(gameState->bullets, j);
         }
     }
 }
 
 void spawnEnemy(GameState* gameState, EnemyType type) {
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (!gameState->enemies[i].active) {
-            gameState->enemies[i].x = SCREEN_WIDTH + 20;
-            
-            float enemyHeight;
-            switch (type) {
-                case ENEMY_SMALL:
-                    enemyHeight = 12;
-                    break;
-                case ENEMY_MEDIUM:
-                    enemyHeight = 16;
-                    break;
-                case ENEMY_LARGE:
-                    enemyHeight = 24;
-                    break;
-                case ENEMY_BOSS:
-                    enemyHeight = 48;
-                    break;
-                default:
-                    enemyHeight = 16;
-                    break;
-            }
-            
-            float minY = enemyHeight / 2;
-            float maxY = SCREEN_HEIGHT - enemyHeight;
-            float spawnY = (float)(rng_u32() % (uint32_t)(maxY - minY)) + minY;
-            
-            gameState->enemies[i].y = spawnY;
-            gameState->enemies[i].active = true;
-            gameState->enemies[i].type = type;
-            gameState->enemies[i].movementPattern = (float)(rng_u32() % 628u) / 100.0f; 
-            
-            switch (type) {
-                case ENEMY_SMALL:
-                    gameState->enemies[i].width = 16;
-                    gameState->enemies[i].height = 12;
-                    gameState->enemies[i].speed = 80.0f + (gameState->level.number * 5.0f);
-                    gameState->enemies[i].health = 1;
-                    gameState->enemies[i].score = 30;
-                    break;
-                case ENEMY_MEDIUM:
-                    gameState->enemies[i].width = 24;
-                    gameState->enemies[i].height = 16;
-                    gameState->enemies[i].speed = 60.0f + (gameState->level.number * 3.0f);
-                    gameState->enemies[i].health = 2;
-                    gameState->enemies[i].score = 50;
-                    break;
-                case ENEMY_LARGE:
-                    gameState->enemies[i].width = 32;
-                    gameState->enemies[i].height = 24;
-                    gameState->enemies[i].speed = 40.0f + (gameState->level.number * 2.0f);
-                    gameState->enemies[i].health = 3;
-                    gameState->enemies[i].score = 150;
-                    gameState->enemies[i].bulletCooldown = (float)(rng_u32() % 3u) + 1.0f;
-                    break;
-                case ENEMY_BOSS:
-                    gameState->enemies[i].width = 64;
-                    gameState->enemies[i].height = 48;
-                    gameState->enemies[i].speed = 20.0f;
-                    gameState->enemies[i].health = 10 + (gameState->level.number * 5);
-                    gameState->enemies[i].score = 200 * gameState->level.number;
-                    gameState->enemies[i].movementPattern = 0.0f;
-                    break;
-                default:
-                    break;
-            }
+    int i = POOL_ACQUIRE(gameState->enemies);
+    if (i < 0) {
+        return;
+    }
+
+    gameState->enemies.x[i] = SCREEN_WIDTH + 20;
+    
+    float enemyHeight;
+    switch (type) {
+        case ENEMY_SMALL:
+            enemyHeight = 12;
+            break;
+        case ENEMY_MEDIUM:
+            enemyHeight = 16;
+            break;
+        case ENEMY_LARGE:
+            enemyHeight = 24;
+            break;
+        case ENEMY_BOSS:
+            enemyHeight = 48;
+            break;
+        default:
+            enemyHeight = 16;
+            break;
+    }
+    
+    float minY = enemyHeight / 2;
+    float maxY = SCREEN_HEIGHT - enemyHeight;
+    float spawnY = (float)rng_range((uint32_t)(maxY - minY)) + minY;
+    
+    gameState->enemies.y[i] = spawnY;
+    SNAP_PREVIOUS(gameState->enemies, i);
+    gameState->enemies.type[i] = type;
+    gameState->enemies.movementPattern[i] = (float)rng_range(628u) / 100.0f; 
+    
+    switch (type) {
+        case ENEMY_SMALL:
+            gameState->enemies.width[i] = 16;
+            gameState->enemies.height[i] = 12;
+            gameState->enemies.speed[i] = 80.0f + (gameState->level.number * 5.0f);
+            gameState->enemies.health[i] = 1;
+            gameState->enemies.score[i] = 30;
+            break;
+        case ENEMY_MEDIUM:
+            gameState->enemies.width[i] = 24;
+            gameState->enemies.height[i] = 16;
+            gameState->enemies.speed[i] = 60.0f + (gameState->level.number * 3.0f);
+            gameState->enemies.health[i] = 2;
+            gameState->enemies.score[i] = 50;
+            break;
+        case ENEMY_LARGE:
+            gameState->enemies.width[i] = 32;
+            gameState->enemies.height[i] = 24;
+            gameState->enemies.speed[i] = 40.0f + (gameState->level.number * 2.0f);
+            gameState->enemies.health[i] = 3;
+            gameState->enemies.score[i] = 150;
+            gameState->enemies.bulletCooldown[i] = (float)rng_range(3u) + 1.0f;
+            break;
+        case ENEMY_BOSS:
+            gameState->enemies.width[i] = 64;
+            gameState->enemies.height[i] = 48;
+            gameState->enemies.speed[i] = 20.0f;
+            gameState->enemies.health[i] = 10 + (gameState->level.number * 5);
+            gameState->enemies.score[i] = 200 * gameState->level.number;
+            gameState->enemies.movementPattern[i] = 0.0f;
+            break;
+        default:
             break;
-        }
     }
 }
 
 void spawnBoss(GameState* gameState) {
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (!gameState->enemies[i].active) {
-            float bossWidth = 64;
-            float bossHeight = 48;
-            
-            float bossX = SCREEN_WIDTH - bossWidth;
-            if (bossX < SCREEN_WIDTH / 2) {
-                bossX = SCREEN_WIDTH / 2;
-            }
-            
-            gameState->enemies[i].x = bossX;
-            gameState->enemies[i].y = SCREEN_HEIGHT / 2;
-            gameState->enemies[i].width = bossWidth;
-            gameState->enemies[i].height = bossHeight;
-            gameState->enemies[i].speed = 20.0f;
-            gameState->enemies[i].health = 10 + (gameState->level.number * 5);
-            gameState->enemies[i].type = ENEMY_BOSS;
-            gameState->enemies[i].active = true;
-            gameState->enemies[i].bulletCooldown = 1.0f;
-            gameState->enemies[i].score = 100 * gameState->level.number;
-            gameState->enemies[i].movementPattern = 0.0f;
-            break;
-        }
+    int i = POOL_ACQUIRE(gameState->enemies);
+    if (i < 0) {
+        return;
+    }
+
+    float bossWidth = 64;
+    float bossHeight = 48;
+    
+    float bossX = SCREEN_WIDTH - bossWidth;
+    if (bossX < SCREEN_WIDTH / 2) {
+        bossX = SCREEN_WIDTH / 2;
     }
+    
+    gameState->enemies.x[i] = bossX;
+    gameState->enemies.y[i] = SCREEN_HEIGHT / 2;
+    SNAP_PREVIOUS(gameState->enemies, i);
+    gameState->enemies.width[i] = bossWidth;
+    gameState->enemies.height[i] = bossHeight;
+    gameState->enemies.speed[i] = 20.0f;
+    gameState->enemies.health[i] = 10 + (gameState->level.number * 5);
+    gameState->enemies.type[i] = ENEMY_BOSS;
+    gameState->enemies.bulletCooldown[i] = 1.0f;
+    gameState->enemies.score[i] = 100 * gameState->level.number;
+    gameState->enemies.movementPattern[i] = 0.0f;
 }
 
 void spawnPowerup(GameState* gameState, float x, float y) {
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (!gameState->powerups[i].active) {
-            if (y < POWERUP_HEIGHT / 2) {
-                y = POWERUP_HEIGHT / 2;
-            } else if (y > SCREEN_HEIGHT - POWERUP_HEIGHT) {
-                y = SCREEN_HEIGHT - POWERUP_HEIGHT;
-            }
-            
-            gameState->powerups[i].x = x;
-            gameState->powerups[i].y = y;
-            gameState->powerups[i].width = POWERUP_WIDTH;
-            gameState->powerups[i].height = POWERUP_HEIGHT;
-            gameState->powerups[i].speed = 60.0f;
-            gameState->powerups[i].active = true;
-            
-            int type = (int)(rng_u32() % 3u);
-            if (gameState->player.lives < 3 && (rng_u32() % 100u) < 40u) {
-                gameState->powerups[i].type = POWERUP_HEALTH;
-            } else {
-                gameState->powerups[i].type = (PowerupType)type;
-            }
-            break;
-        }
+    int i = POOL_ACQUIRE(gameState->powerups);
+    if (i < 0) {
+        return;
+    }
+
+    if (y < POWERUP_HEIGHT / 2) {
+        y = POWERUP_HEIGHT / 2;
+    } else if (y > SCREEN_HEIGHT - POWERUP_HEIGHT) {
+        y = SCREEN_HEIGHT - POWERUP_HEIGHT;
+    }
+    
+    gameState->powerups.x[i] = x;
+    gameState->powerups.y[i] = y;
+    SNAP_PREVIOUS(gameState->powerups, i);
+    gameState->powerups.width[i] = POWERUP_WIDTH;
+    gameState->powerups.height[i] = POWERUP_HEIGHT;
+    gameState->powerups.speed[i] = 60.0f;
+    
+    int type = (int)rng_range(3u);
+    if (gameState->player.lives < 3 && rng_range(100u) < 40u) {
+        gameState->powerups.type[i] = POWERUP_HEALTH;
+    } else {
+        gameState->powerups.type[i] = (PowerupType)type;
     }
 }
 
 void createExplosion(GameState* gameState, float x, float y, float size) {
-    int index = -1;
-
-    for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-        if (!gameState->explosions[i].active) {
-            index = i;
-            break;
-        }
+    ExplosionPool* explosions = &gameState->explosions;
+    if (explosions->recycleCount < 0) {
+        rebuildRecycleRing(explosions);
     }
+    int index = POOL_ACQUIRE(*explosions);
 
+    // Benchmark mode keeps the pool saturated, so recycle the explosion closest
+    // to expiring, preferring transient ones over the looping scene fillers.
+    // The oldest transient one is the front of the ring; only a pool of
+    // nothing but fillers is searched.
     if (index < 0 && gameState->benchmarkMode) {
-        float lowestLife = 1e9f;
-        int best = -1;
-
-        for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-            if (!gameState->explosions[i].persistent) {
-                float life = gameState->explosions[i].currentLife;
-                if (life < lowestLife) {
-                    lowestLife = life;
-                    best = i;
-                }
-            }
-        }
-
-        if (best < 0) {
-            for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-                float life = gameState->explosions[i].currentLife;
-                if (life < lowestLife) {
-                    lowestLife = life;
-                    best = i;
+        if (explosions->recycleCount > 0) {
+            index = recyclePop(explosions);
+        } else {
+            float lowestLife = 1e9f;
+            for (int i = 0; i < explosions->count; i++) {
+                if (explosions->currentLife[i] < lowestLife) {
+                    lowestLife = explosions->currentLife[i];
+                    index = i;
                 }
             }
         }
-
-        index = best;
     }
 
     if (index < 0) {
@@ -780,231 +1324,328 @@ void createExplosion(GameState* gameState, float x, float y, float size) {
         y = SCREEN_HEIGHT - size;
     }
 
-    gameState->explosions[index].x = x;
-    gameState->explosions[index].y = y;
-    gameState->explosions[index].width = size;
-    gameState->explosions[index].height = size;
-    gameState->explosions[index].lifespan = 0.5f;
-    gameState->explosions[index].currentLife = 0.5f;
-    gameState->explosions[index].active = true;
-    gameState->explosions[index].persistent = false;
+    gameState->explosions.x[index] = x;
+    gameState->explosions.y[index] = y;
+    gameState->explosions.width[index] = size;
+    gameState->explosions.height[index] = size;
+    gameState->explosions.lifespan[index] = 0.5f;
+    gameState->explosions.currentLife[index] = 0.5f;
+    gameState->explosions.persistent[index] = false;
+    gameState->explosions.spawnSequence[index] = explosions->nextSpawnSequence++;
+    recyclePush(explosions, index);
 }
 
-void handleCollisions(GameState* gameState) {
-    buildEnemyGrid(gameState);
-    buildEnemyBulletGrid(gameState);
-    buildPowerupGrid(gameState);
-
-    bool enemyPlayerChecked[MAX_ENEMIES] = {false};
-
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (gameState->bullets[i].active) {
-            float bxMin = gameState->bullets[i].x;
-            float bxMax = gameState->bullets[i].x + gameState->bullets[i].width;
-            float byMin = gameState->bullets[i].y;
-            float byMax = gameState->bullets[i].y + gameState->bullets[i].height;
-
-            int colStart = clampInt((int)(bxMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-            int colEnd   = clampInt((int)(bxMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-            int rowStart = clampInt((int)(byMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-            int rowEnd   = clampInt((int)(byMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-            for (int r = rowStart; r <= rowEnd && gameState->bullets[i].active; r++) {
-                for (int c = colStart; c <= colEnd && gameState->bullets[i].active; c++) {
-                    int count = enemyGridCount[r][c];
-                    for (int idx = 0; idx < count && gameState->bullets[i].active; idx++) {
-                        int j = enemyGrid[r][c][idx];
-                        if (!gameState->enemies[j].active) {
-                            continue;
-                        }
+// Grows an index buffer to hold at least needed entries, keeping its contents.
+static int* reserveIndices(int* buffer, int* capacity, int needed) {
+    if (buffer && needed <= *capacity) {
+        return buffer;
+    }
 
-                        if (gameState->bullets[i].x < gameState->enemies[j].x + gameState->enemies[j].width &&
-                            gameState->bullets[i].x + gameState->bullets[i].width > gameState->enemies[j].x &&
-                            gameState->bullets[i].y < gameState->enemies[j].y + gameState->enemies[j].height &&
-                            gameState->bullets[i].y + gameState->bullets[i].height > gameState->enemies[j].y) {
-
-                            gameState->enemies[j].health--;
-                            gameState->bullets[i].active = false;
-
-                            if (gameState->enemies[j].health <= 0) {
-                                gameState->player.score += gameState->enemies[j].score;
-
-                                createExplosion(gameState, gameState->enemies[j].x, gameState->enemies[j].y,
-                                                gameState->enemies[j].width * 1.5f);
-
-                                if (gameState->enemies[j].type == ENEMY_BOSS) {
-                                    if (!gameState->benchmarkMode) {
-                                        gameState->level.bossDefeated = true;
-                                        spawnPowerup(gameState, gameState->enemies[j].x, gameState->enemies[j].y);
-                                    } else {
-                                        spawnPowerup(gameState, gameState->enemies[j].x, gameState->enemies[j].y);
-                                    }
-                                }
-
-                                if (gameState->enemies[j].type != ENEMY_BOSS && (rng_u32() % 100u) < 10u) {
-                                    spawnPowerup(gameState, gameState->enemies[j].x, gameState->enemies[j].y);
-                                }
-
-                                if (gameState->benchmarkMode) {
-                                    respawnEnemyRight(gameState, j);
-                                } else {
-                                    gameState->enemies[j].active = false;
-                                }
+    int grown = *capacity > 0 ? *capacity : 256;
+    while (grown < needed) {
+        grown *= 2;
+    }
+
+    buffer = realloc(buffer, sizeof(int) * (size_t)grown);
+    if (!buffer) {
+        printf("Failed to allocate collision candidates (%d entries)\n", grown);
+        exit(EXIT_FAILURE);
+    }
+    *capacity = grown;
+    return buffer;
+}
+
+// Appends hits to a chunk's candidate list. The list doubles into fresh frame
+// memory when full; the old copy is reclaimed with the rest of the frame.
+static void appendCandidates(HitCandidates* chunk, FrameArena* frame, const int* hits, int count) {
+    if (chunk->count + count > chunk->capacity) {
+        int grown = chunk->capacity > 0 ? chunk->capacity * 2 : COLLISION_GRAIN * 4;
+        while (grown < chunk->count + count) {
+            grown *= 2;
+        }
+        int* enemies = frameAlloc(frame, sizeof(int) * (size_t)grown);
+        if (chunk->count > 0) {
+            memcpy(enemies, chunk->enemies, sizeof(int) * (size_t)chunk->count);
+        }
+        chunk->enemies = enemies;
+        chunk->capacity = grown;
+    }
+    memcpy(chunk->enemies + chunk->count, hits, sizeof(int) * (size_t)count);
+    chunk->count += count;
+}
+
+// Detection half of bullet-vs-enemy: queries the enemy broad phase for each
+// bullet and records the candidates without changing any game state.
+static void detectBulletHitsRange(void* ctx, int begin, int end) {
+    const BulletPool* bullets = &((SimJob*)ctx)->gameState->bullets;
+    HitCandidates* chunk = &hitCandidates[begin / COLLISION_GRAIN];
+    ThreadScratch* thread = &threadScratch[jobsThreadIndex()];
+    int enemyCount = enemyBroadPhase.count;
+    TRACE_BEGIN("detect chunk");
+
+    chunk->enemies = NULL;
+    chunk->count = 0;
+    chunk->capacity = 0;
+    broadPhaseScratchReserve(&thread->query, enemyCount);
+    thread->hits = reserveIndices(thread->hits, &thread->hitsCapacity, enemyCount);
+    for (int i = begin; i < end; i++) {
+        int found = broadPhaseQueryInto(&enemyBroadPhase, bullets->x[i], bullets->y[i],
+                                        bullets->x[i] + bullets->width[i],
+                                        bullets->y[i] + bullets->height[i],
+                                        thread->hits, &thread->query);
+        bulletCandidateCount[i] = found;
+        if (found > 0) {
+            appendCandidates(chunk, &thread->frame, thread->hits, found);
+        }
+    }
+    TRACE_END();
+}
+
+MODE_INLINE void handleCollisionsMode(const bool bench, GameState* gameState) {
+    enemyBroadPhase.kind = gameState->broadPhase;
+    enemyBulletBroadPhase.kind = gameState->broadPhase;
+    powerupBroadPhase.kind = gameState->broadPhase;
+
+    TRACE_BEGIN("handleCollisions");
+    // Whatever updateGame allocated is dead by the time it gets here.
+    beginFrame();
+
+    TRACE_BEGIN("build enemies");
+    broadPhaseBuild(&enemyBroadPhase, gameState->enemies.x, gameState->enemies.y,
+                    gameState->enemies.width, gameState->enemies.height, gameState->enemies.count);
+    TRACE_END();
+    TRACE_BEGIN("build enemyBullets");
+    broadPhaseBuild(&enemyBulletBroadPhase, gameState->enemyBullets.x, gameState->enemyBullets.y,
+                    gameState->enemyBullets.width, gameState->enemyBullets.height, gameState->enemyBullets.count);
+    TRACE_END();
+    TRACE_BEGIN("build powerups");
+    broadPhaseBuild(&powerupBroadPhase, gameState->powerups.x, gameState->powerups.y,
+                    gameState->powerups.width, gameState->powerups.height, gameState->powerups.count);
+    TRACE_END();
+
+    if (gameState->verifyBroadPhase) {
+        TRACE_BEGIN("verify broad phase");
+        Player* p = &gameState->player;
+        gameState->broadPhaseMismatches +=
+            broadPhaseCrossCheck(&enemyBroadPhase, gameState->bullets.x, gameState->bullets.y,
+                                 gameState->bullets.width, gameState->bullets.height, gameState->bullets.count) +
+            broadPhaseCrossCheck(&enemyBroadPhase, &p->x, &p->y, &p->width, &p->height, 1) +
+            broadPhaseCrossCheck(&enemyBulletBroadPhase, &p->x, &p->y, &p->width, &p->height, 1) +
+            broadPhaseCrossCheck(&powerupBroadPhase, &p->x, &p->y, &p->width, &p->height, 1);
+        TRACE_END();
+    }
+
+    // Bullets vs enemies runs in two phases. Detection fans out over the job
+    // system and only reads the broad phase; resolution then walks bullets
+    // and their candidates in index order on this thread, so health, score,
+    // RNG draws and pool appends happen exactly as in a serial pass.
+    SimJob job = { gameState, 0.0f };
+    TRACE_BEGIN("bullets vs enemies: detect");
+    int bulletCount = gameState->bullets.count;
+    hitCandidates = frameScratch(sizeof(HitCandidates) * (size_t)CHUNKS(bulletCount, COLLISION_GRAIN));
+    bulletCandidateCount = frameScratch(sizeof(int) * (size_t)bulletCount);
+    jobsParallelFor(bulletCount, COLLISION_GRAIN, detectBulletHitsRange, &job);
+    TRACE_END();
+
+    TRACE_BEGIN("bullets vs enemies: resolve");
+    for (int begin = 0; begin < gameState->bullets.count; begin += COLLISION_GRAIN) {
+        // Null when the chunk found nothing, so index rather than advance it.
+        const int* candidates = hitCandidates[begin / COLLISION_GRAIN].enemies;
+        int next = 0;
+        int end = begin + COLLISION_GRAIN < gameState->bullets.count ? begin + COLLISION_GRAIN
+                                                                     : gameState->bullets.count;
+        for (int i = begin; i < end; i++) {
+            int hits = bulletCandidateCount[i];
+            for (int h = 0; h < hits && gameState->bullets.active[i]; h++) {
+                int j = candidates[next + h];
+                if (!gameState->enemies.active[j]) {
+                    continue;
+                }
+
+                // Broad-phase boxes are a snapshot from the start of the pass;
+                // benchmark respawns can move an enemy since then.
+                if (gameState->bullets.x[i] < gameState->enemies.x[j] + gameState->enemies.width[j] &&
+                    gameState->bullets.x[i] + gameState->bullets.width[i] > gameState->enemies.x[j] &&
+                    gameState->bullets.y[i] < gameState->enemies.y[j] + gameState->enemies.height[j] &&
+                    gameState->bullets.y[i] + gameState->bullets.height[i] > gameState->enemies.y[j]) {
+
+                    gameState->enemies.health[j]--;
+                    POOL_RELEASE(gameState->bullets, i);
+
+                    if (gameState->enemies.health[j] <= 0) {
+                        gameState->player.score += gameState->enemies.score[j];
+
+                        createExplosion(gameState, gameState->enemies.x[j], gameState->enemies.y[j],
+                                        gameState->enemies.width[j] * 1.5f);
+
+                        if (gameState->enemies.type[j] == ENEMY_BOSS) {
+                            if (!bench) {
+                                gameState->level.bossDefeated = true;
                             }
+                            spawnPowerup(gameState, gameState->enemies.x[j], gameState->enemies.y[j]);
+                        }
+
+                        if (gameState->enemies.type[j] != ENEMY_BOSS && rng_range(100u) < 10u) {
+                            spawnPowerup(gameState, gameState->enemies.x[j], gameState->enemies.y[j]);
+                        }
+
+                        if (bench) {
+                            respawnEnemyRight(gameState, j);
+                        } else {
+                            POOL_RELEASE(gameState->enemies, j);
                         }
                     }
                 }
             }
+            next += hits;
         }
     }
-    
+    TRACE_END();
+
     // Enemy bullets vs player
+    TRACE_BEGIN("player vs enemyBullets");
     {
         float pxMin = gameState->player.x;
         float pxMax = gameState->player.x + gameState->player.width;
         float pyMin = gameState->player.y;
         float pyMax = gameState->player.y + gameState->player.height;
 
-        int colStart = clampInt((int)(pxMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int colEnd   = clampInt((int)(pxMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int rowStart = clampInt((int)(pyMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-        int rowEnd   = clampInt((int)(pyMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-        for (int r = rowStart; r <= rowEnd; r++) {
-            for (int c = colStart; c <= colEnd; c++) {
-                int count = enemyBulletGridCount[r][c];
-                for (int idx = 0; idx < count; idx++) {
-                    int i = enemyBulletGrid[r][c][idx];
-                    if (!gameState->enemyBullets[i].active) {
-                        continue;
-                    }
-
-                    if (gameState->enemyBullets[i].x < gameState->player.x + gameState->player.width &&
-                        gameState->enemyBullets[i].x + gameState->enemyBullets[i].width > gameState->player.x &&
-                        gameState->enemyBullets[i].y < gameState->player.y + gameState->player.height &&
-                        gameState->enemyBullets[i].y + gameState->enemyBullets[i].height > gameState->player.y) {
+        int hits = broadPhaseQuery(&enemyBulletBroadPhase, pxMin, pyMin, pxMax, pyMax);
 
-                        if (!gameState->benchmarkMode) {
-                            gameState->player.lives--;
-                        }
-                        gameState->enemyBullets[i].active = false;
+        for (int h = 0; h < hits; h++) {
+            int i = enemyBulletBroadPhase.results[h];
+            if (!gameState->enemyBullets.active[i]) {
+                continue;
+            }
 
-                        createExplosion(gameState, gameState->player.x, gameState->player.y, gameState->player.width);
+            if (gameState->enemyBullets.x[i] < gameState->player.x + gameState->player.width &&
+                gameState->enemyBullets.x[i] + gameState->enemyBullets.width[i] > gameState->player.x &&
+                gameState->enemyBullets.y[i] < gameState->player.y + gameState->player.height &&
+                gameState->enemyBullets.y[i] + gameState->enemyBullets.height[i] > gameState->player.y) {
 
-                        gameState->player.isRapidFire = false;
-                        gameState->player.isDoubleBullet = false;
-                        gameState->player.powerupTimer = 0.0f;
-                    }
+                if (!bench) {
+                    gameState->player.lives--;
                 }
+                POOL_RELEASE(gameState->enemyBullets, i);
+
+                createExplosion(gameState, gameState->player.x, gameState->player.y, gameState->player.width);
+
+                gameState->player.isRapidFire = false;
+                gameState->player.isDoubleBullet = false;
+                gameState->player.powerupTimer = 0.0f;
             }
         }
     }
 
+    TRACE_END();
+
     // Enemies vs player
+    TRACE_BEGIN("player vs enemies");
     {
         float pxMin = gameState->player.x;
         float pxMax = gameState->player.x + gameState->player.width;
         float pyMin = gameState->player.y;
         float pyMax = gameState->player.y + gameState->player.height;
 
-        int colStart = clampInt((int)(pxMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int colEnd   = clampInt((int)(pxMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int rowStart = clampInt((int)(pyMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-        int rowEnd   = clampInt((int)(pyMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-        for (int r = rowStart; r <= rowEnd; r++) {
-            for (int c = colStart; c <= colEnd; c++) {
-                int count = enemyGridCount[r][c];
-                for (int idx = 0; idx < count; idx++) {
-                    int i = enemyGrid[r][c][idx];
-                    if (enemyPlayerChecked[i]) {
-                        continue;
-                    }
-                    enemyPlayerChecked[i] = true;
-
-                    if (!gameState->enemies[i].active) {
-                        continue;
-                    }
+        int hits = broadPhaseQuery(&enemyBroadPhase, pxMin, pyMin, pxMax, pyMax);
 
-                    if (gameState->enemies[i].x < gameState->player.x + gameState->player.width &&
-                        gameState->enemies[i].x + gameState->enemies[i].width > gameState->player.x &&
-                        gameState->enemies[i].y < gameState->player.y + gameState->player.height &&
-                        gameState->enemies[i].y + gameState->enemies[i].height > gameState->player.y) {
+        for (int h = 0; h < hits; h++) {
+            int i = enemyBroadPhase.results[h];
+            if (!gameState->enemies.active[i]) {
+                continue;
+            }
 
-                        if (!gameState->benchmarkMode) {
-                            gameState->player.lives--;
-                        }
+            if (gameState->enemies.x[i] < gameState->player.x + gameState->player.width &&
+                gameState->enemies.x[i] + gameState->enemies.width[i] > gameState->player.x &&
+                gameState->enemies.y[i] < gameState->player.y + gameState->player.height &&
+                gameState->enemies.y[i] + gameState->enemies.height[i] > gameState->player.y) {
 
-                        createExplosion(gameState, gameState->player.x, gameState->player.y, gameState->player.width);
-                        createExplosion(gameState, gameState->enemies[i].x, gameState->enemies[i].y, gameState->enemies[i].width);
+                if (!bench) {
+                    gameState->player.lives--;
+                }
 
-                        if (gameState->enemies[i].type != ENEMY_BOSS) {
-                            if (gameState->benchmarkMode) {
-                                respawnEnemyRight(gameState, i);
-                            } else {
-                                gameState->enemies[i].active = false;
-                            }
-                        } else {
-                            gameState->player.x = 50.0f;
-                        }
+                createExplosion(gameState, gameState->player.x, gameState->player.y, gameState->player.width);
+                createExplosion(gameState, gameState->enemies.x[i], gameState->enemies.y[i], gameState->enemies.width[i]);
 
-                        gameState->player.isRapidFire = false;
-                        gameState->player.isDoubleBullet = false;
-                        gameState->player.powerupTimer = 0.0f;
+                if (gameState->enemies.type[i] != ENEMY_BOSS) {
+                    if (bench) {
+                        respawnEnemyRight(gameState, i);
+                    } else {
+                        POOL_RELEASE(gameState->enemies, i);
                     }
+                } else {
+                    gameState->player.x = 50.0f;
+                    gameState->player.prevX = gameState->player.x;
+                    gameState->player.prevY = gameState->player.y;
                 }
+
+                gameState->player.isRapidFire = false;
+                gameState->player.isDoubleBullet = false;
+                gameState->player.powerupTimer = 0.0f;
             }
         }
     }
 
+    TRACE_END();
+
     // Powerups vs player
+    TRACE_BEGIN("player vs powerups");
     {
         float pxMin = gameState->player.x;
         float pxMax = gameState->player.x + gameState->player.width;
         float pyMin = gameState->player.y;
         float pyMax = gameState->player.y + gameState->player.height;
 
-        int colStart = clampInt((int)(pxMin / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int colEnd   = clampInt((int)(pxMax / GRID_CELL_SIZE), 0, GRID_COLS - 1);
-        int rowStart = clampInt((int)(pyMin / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-        int rowEnd   = clampInt((int)(pyMax / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
-
-        for (int r = rowStart; r <= rowEnd; r++) {
-            for (int c = colStart; c <= colEnd; c++) {
-                int count = powerupGridCount[r][c];
-                for (int idx = 0; idx < count; idx++) {
-                    int i = powerupGrid[r][c][idx];
-                    if (!gameState->powerups[i].active) {
-                        continue;
-                    }
+        int hits = broadPhaseQuery(&powerupBroadPhase, pxMin, pyMin, pxMax, pyMax);
 
-                    if (gameState->powerups[i].x < gameState->player.x + gameState->player.width &&
-                        gameState->powerups[i].x + gameState->powerups[i].width > gameState->player.x &&
-                        gameState->powerups[i].y < gameState->player.y + gameState->player.height &&
-                        gameState->powerups[i].y + gameState->powerups[i].height > gameState->player.y) {
-
-                        switch (gameState->powerups[i].type) {
-                            case POWERUP_HEALTH:
-                                if (gameState->player.lives < 3) {
-                                    gameState->player.lives++;
-                                }
-                                break;
-                            case POWERUP_RAPID_FIRE:
-                                gameState->player.isRapidFire = true;
-                                gameState->player.powerupTimer = POWERUP_DURATION;
-                                break;
-                            case POWERUP_DOUBLE_BULLET:
-                                gameState->player.isDoubleBullet = true;
-                                gameState->player.powerupTimer = POWERUP_DURATION;
-                                break;
-                        }
+        for (int h = 0; h < hits; h++) {
+            int i = powerupBroadPhase.results[h];
+            if (!gameState->powerups.active[i]) {
+                continue;
+            }
 
-                        gameState->powerups[i].active = false;
-                    }
+            if (gameState->powerups.x[i] < gameState->player.x + gameState->player.width &&
+                gameState->powerups.x[i] + gameState->powerups.width[i] > gameState->player.x &&
+                gameState->powerups.y[i] < gameState->player.y + gameState->player.height &&
+                gameState->powerups.y[i] + gameState->powerups.height[i] > gameState->player.y) {
+
+                switch (gameState->powerups.type[i]) {
+                    case POWERUP_HEALTH:
+                        if (gameState->player.lives < 3) {
+                            gameState->player.lives++;
+                        }
+                        break;
+                    case POWERUP_RAPID_FIRE:
+                        gameState->player.isRapidFire = true;
+                        gameState->player.powerupTimer = POWERUP_DURATION;
+                        break;
+                    case POWERUP_DOUBLE_BULLET:
+                        gameState->player.isDoubleBullet = true;
+                        gameState->player.powerupTimer = POWERUP_DURATION;
+                        break;
                 }
+
+                POOL_RELEASE(gameState->powerups, i);
             }
         }
     }
+    TRACE_END();
+
+    compactBullets(&gameState->bullets);
+    compactEnemies(&gameState->enemies);
+    compactBullets(&gameState->enemyBullets);
+    compactPowerups(&gameState->powerups);
+
+    TRACE_END();
+}
+MODE_INSTANCES(handleCollisions, (GameState* gameState), gameState)
+
+void handleCollisions(GameState* gameState) {
+    if (gameState->benchmarkMode) {
+        handleCollisionsBench(gameState);
+    } else {
+        handleCollisionsPlay(gameState);
+    }
 }
 
 void nextLevel(GameState* gameState) {
@@ -1017,13 +1658,8 @@ void nextLevel(GameState* gameState) {
         gameState->level.enemySpawnRate = 1.0f;
     }
     
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        gameState->enemies[i].active = false;
-    }
-    
-    for (int i = 0; i < MAX_ENEMY_BULLETS; i++) {
-        gameState->enemyBullets[i].active = false;
-    }
+    gameState->enemies.count = 0;
+    gameState->enemyBullets.count = 0;
     
     gameState->enemySpawnTimer = 2.0f;
     gameState->powerupSpawnTimer = POWERUP_SPAWN_DELAY / 2;
@@ -1034,26 +1670,40 @@ static void respawnEnemyRight(GameState* gameState, int idx) {
     if (bandFrac <= 0.0f) bandFrac = 0.10f;
     if (bandFrac > 1.0f) bandFrac = 1.0f;
     float band = SCREEN_WIDTH * bandFrac;
-    float jitter = (float)(rng_u32() % (uint32_t)(band + 1.0f));
-
-    Enemy* e = &gameState->enemies[idx];
-    float minY = e->height / 2.0f;
-    float maxY = SCREEN_HEIGHT - e->height;
-    e->x = (SCREEN_WIDTH - e->width / 2.0f) - jitter;
-    e->y = minY + (float)(rng_u32() % (uint32_t)(maxY - minY + 1.0f));
-    e->movementPattern = (float)(rng_u32() % 628u) / 100.0f;
-    if (e->type == ENEMY_LARGE) {
-        e->bulletCooldown = (float)(rng_u32() % 3u) * 0.5f + 0.2f;
-    } else if (e->type == ENEMY_BOSS) {
-        e->bulletCooldown = 0.5f;
-    }
-    switch (e->type) {
-        case ENEMY_SMALL: e->health = 1; break;
-        case ENEMY_MEDIUM: e->health = 2; break;
-        case ENEMY_LARGE: e->health = 3; break;
-        case ENEMY_BOSS: e->health = 100; break;
-    }
-    e->active = true;
+    float jitter = (float)rng_range((uint32_t)(band + 1.0f));
+
+    EnemyPool* e = &gameState->enemies;
+    float minY = e->height[idx] / 2.0f;
+    float maxY = SCREEN_HEIGHT - e->height[idx];
+    e->x[idx] = (SCREEN_WIDTH - e->width[idx] / 2.0f) - jitter;
+    e->y[idx] = minY + (float)rng_range((uint32_t)(maxY - minY + 1.0f));
+    SNAP_PREVIOUS(*e, idx);
+    e->movementPattern[idx] = (float)rng_range(628u) / 100.0f;
+    if (e->type[idx] == ENEMY_LARGE) {
+        e->bulletCooldown[idx] = (float)rng_range(3u) * 0.5f + 0.2f;
+    } else if (e->type[idx] == ENEMY_BOSS) {
+        e->bulletCooldown[idx] = 0.5f;
+    }
+    switch (e->type[idx]) {
+        case ENEMY_SMALL: e->health[idx] = 1; break;
+        case ENEMY_MEDIUM: e->health[idx] = 2; break;
+        case ENEMY_LARGE: e->health[idx] = 3; break;
+        case ENEMY_BOSS: e->health[idx] = 100; break;
+    }
+    e->active[idx] = true;
+}
+
+// column[i] = offset + scale * draw for i in [0, n), with draws uniform on
+// [0, range) and generated in bulk.
+static void fillColumnUniform(float* column, int n, uint32_t range, float offset, float scale) {
+    uint32_t draws[256];
+    for (int done = 0; done < n; done += 256) {
+        int count = n - done < 256 ? n - done : 256;
+        rng_fill_range(draws, count, range);
+        for (int i = 0; i < count; i++) {
+            column[done + i] = offset + scale * (float)draws[i];
+        }
+    }
 }
 
 void prepareBenchmarkScene(GameState* gameState, int density) {
@@ -1070,95 +1720,86 @@ void prepareBenchmarkScene(GameState* gameState, int density) {
     gameState->enemySpawnTimer = 0.0f;
     gameState->powerupSpawnTimer = 2.0f;
 
-    int targetBullets = (MAX_BULLETS * density) / 100;
-    int targetEnemyBullets = (MAX_ENEMY_BULLETS * density) / 100;
-    int targetEnemies = (MAX_ENEMIES * density) / 100;
-    int targetPowerups = (MAX_POWERUPS * density) / 100;
-    int targetExplosions = (MAX_EXPLOSIONS * density) / 100;
-
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (i < targetBullets) {
-            gameState->bullets[i].active = true;
-            gameState->bullets[i].width = BULLET_WIDTH;
-            gameState->bullets[i].height = BULLET_HEIGHT;
-            gameState->bullets[i].speed = -BULLET_SPEED;
-            gameState->bullets[i].x = (float)(rng_u32() % SCREEN_WIDTH);
-            gameState->bullets[i].y = (float)(rng_u32() % (SCREEN_HEIGHT - BULLET_HEIGHT)) + BULLET_HEIGHT / 2.0f;
-        } else {
-            gameState->bullets[i].active = false;
-        }
+    int targetBullets = (gameState->bullets.capacity * density) / 100;
+    int targetEnemyBullets = (gameState->enemyBullets.capacity * density) / 100;
+    int targetEnemies = (gameState->enemies.capacity * density) / 100;
+    int targetPowerups = (gameState->powerups.capacity * density) / 100;
+    int targetExplosions = (gameState->explosions.capacity * density) / 100;
+
+    gameState->bullets.count = targetBullets;
+    for (int i = 0; i < targetBullets; i++) {
+        gameState->bullets.active[i] = true;
+        gameState->bullets.width[i] = BULLET_WIDTH;
+        gameState->bullets.height[i] = BULLET_HEIGHT;
+        gameState->bullets.speed[i] = -BULLET_SPEED;
     }
-
-    for (int i = 0; i < MAX_ENEMY_BULLETS; i++) {
-        if (i < targetEnemyBullets) {
-            gameState->enemyBullets[i].active = true;
-            gameState->enemyBullets[i].width = BULLET_WIDTH;
-            gameState->enemyBullets[i].height = BULLET_HEIGHT;
-            gameState->enemyBullets[i].speed = ENEMY_BULLET_SPEED;
-            gameState->enemyBullets[i].x = (float)(SCREEN_WIDTH - (rng_u32() % (SCREEN_WIDTH / 2)));
-            gameState->enemyBullets[i].y = (float)(rng_u32() % (SCREEN_HEIGHT - BULLET_HEIGHT)) + BULLET_HEIGHT / 2.0f;
-        } else {
-            gameState->enemyBullets[i].active = false;
-        }
+    fillColumnUniform(gameState->bullets.x, targetBullets, SCREEN_WIDTH, 0.0f, 1.0f);
+    fillColumnUniform(gameState->bullets.y, targetBullets, SCREEN_HEIGHT - BULLET_HEIGHT,
+                      BULLET_HEIGHT / 2.0f, 1.0f);
+
+    gameState->enemyBullets.count = targetEnemyBullets;
+    for (int i = 0; i < targetEnemyBullets; i++) {
+        gameState->enemyBullets.active[i] = true;
+        gameState->enemyBullets.width[i] = BULLET_WIDTH;
+        gameState->enemyBullets.height[i] = BULLET_HEIGHT;
+        gameState->enemyBullets.speed[i] = ENEMY_BULLET_SPEED;
     }
+    fillColumnUniform(gameState->enemyBullets.x, targetEnemyBullets, SCREEN_WIDTH / 2, SCREEN_WIDTH, -1.0f);
+    fillColumnUniform(gameState->enemyBullets.y, targetEnemyBullets, SCREEN_HEIGHT - BULLET_HEIGHT,
+                      BULLET_HEIGHT / 2.0f, 1.0f);
 
-    int enemiesPlaced = 0;
     int bossTarget = 0;
     if (targetEnemies > 0) {
         bossTarget = 10;
         if (bossTarget > targetEnemies) bossTarget = targetEnemies;
     }
     int bossesPlaced = 0;
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemiesPlaced >= targetEnemies) {
-            gameState->enemies[i].active = false;
-            continue;
-        }
-
+    gameState->enemies.count = targetEnemies;
+    for (int i = 0; i < targetEnemies; i++) {
         EnemyType type;
         if (bossesPlaced < bossTarget) {
             type = ENEMY_BOSS;
             bossesPlaced++;
         } else {
-            int r = (int)(rng_u32() % 100u);
+            int r = (int)rng_range(100u);
             if (r < 60) type = ENEMY_SMALL; else if (r < 85) type = ENEMY_MEDIUM; else type = ENEMY_LARGE;
         }
 
-        gameState->enemies[i].type = type;
-        gameState->enemies[i].active = true;
-        gameState->enemies[i].movementPattern = (float)(rng_u32() % 628u) / 100.0f;
+        gameState->enemies.type[i] = type;
+        gameState->enemies.active[i] = true;
+        gameState->enemies.movementPattern[i] = (float)rng_range(628u) / 100.0f;
 
         switch (type) {
             case ENEMY_SMALL:
-                gameState->enemies[i].width = 16;
-                gameState->enemies[i].height = 12;
-                gameState->enemies[i].speed = 90.0f + (gameState->level.number * 5.0f);
-                gameState->enemies[i].health = 1;
-                gameState->enemies[i].score = 30;
+                gameState->enemies.width[i] = 16;
+                gameState->enemies.height[i] = 12;
+                gameState->enemies.speed[i] = 90.0f + (gameState->level.number * 5.0f);
+                gameState->enemies.health[i] = 1;
+                gameState->enemies.score[i] = 30;
                 break;
             case ENEMY_MEDIUM:
-                gameState->enemies[i].width = 24;
-                gameState->enemies[i].height = 16;
-                gameState->enemies[i].speed = 70.0f + (gameState->level.number * 3.0f);
-                gameState->enemies[i].health = 2;
-                gameState->enemies[i].score = 50;
+                gameState->enemies.width[i] = 24;
+                gameState->enemies.height[i] = 16;
+                gameState->enemies.speed[i] = 70.0f + (gameState->level.number * 3.0f);
+                gameState->enemies.health[i] = 2;
+                gameState->enemies.score[i] = 50;
                 break;
             case ENEMY_LARGE:
-                gameState->enemies[i].width = 32;
-                gameState->enemies[i].height = 24;
-                gameState->enemies[i].speed = 50.0f + (gameState->level.number * 2.0f);
-                gameState->enemies[i].health = 3;
-                gameState->enemies[i].score = 150;
-                gameState->enemies[i].bulletCooldown = 0.2f;
+                gameState->enemies.width[i] = 32;
+                gameState->enemies.height[i] = 24;
+                gameState->enemies.speed[i] = 50.0f + (gameState->level.number * 2.0f);
+                gameState->enemies.health[i] = 3;
+                gameState->enemies.score[i] = 150;
+                gameState->enemies.bulletCooldown[i] = 0.2f;
                 break;
             case ENEMY_BOSS:
-                gameState->enemies[i].width = 64;
-                gameState->enemies[i].height = 48;
-                gameState->enemies[i].speed = 20.0f;
-                gameState->enemies[i].health = 100;
-                gameState->enemies[i].score = 1000;
-                gameState->enemies[i].movementPattern = 0.0f;
-                gameState->enemies[i].bulletCooldown = 0.5f;
+                gameState->enemies.width[i] = 64;
+                gameState->enemies.height[i] = 48;
+                gameState->enemies.speed[i] = 20.0f;
+                gameState->enemies.health[i] = 100;
+                gameState->enemies.score[i] = 1000;
+                gameState->enemies.movementPattern[i] = 0.0f;
+                gameState->enemies.bulletCooldown[i] = 0.5f;
                 break;
         }
 
@@ -1172,54 +1813,49 @@ void prepareBenchmarkScene(GameState* gameState, int density) {
             if (bossBand < 0.30f) bossBand = 0.30f;
             if (bossBand > 1.0f) bossBand = 1.0f;
             exMin = SCREEN_WIDTH * (1.0f - bossBand);
-            exMax = SCREEN_WIDTH - gameState->enemies[i].width / 2.0f;
+            exMax = SCREEN_WIDTH - gameState->enemies.width[i] / 2.0f;
             float bandWidth = (exMax - exMin);
             if (bandWidth < 1.0f) bandWidth = 1.0f;
             int bossIndex = bossesPlaced - 1;
             if (bossIndex < 0) bossIndex = 0;
             if (bossTarget < 1) bossTarget = 1;
             float slot = bandWidth / (float)bossTarget;
-            float jitter = slot * 0.2f * ((float)(rng_u32() % 100u) / 100.0f);
-            gameState->enemies[i].x = exMin + slot * bossIndex + slot * 0.4f + jitter;
+            float jitter = slot * 0.2f * ((float)rng_range(100u) / 100.0f);
+            gameState->enemies.x[i] = exMin + slot * bossIndex + slot * 0.4f + jitter;
         } else {
             exMin = SCREEN_WIDTH * (1.0f - bandFrac);
-            exMax = SCREEN_WIDTH - gameState->enemies[i].width / 2.0f;
-            gameState->enemies[i].x = exMin + (float)(rng_u32() % (uint32_t)(exMax - exMin + 1.0f));
-        }
-        float eyMin = gameState->enemies[i].height / 2.0f;
-        float eyMax = SCREEN_HEIGHT - gameState->enemies[i].height;
-        gameState->enemies[i].y = eyMin + (float)(rng_u32() % (uint32_t)(eyMax - eyMin + 1.0f));
-
-        enemiesPlaced++;
-    }
-
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (i < targetPowerups) {
-            gameState->powerups[i].active = true;
-            gameState->powerups[i].width = POWERUP_WIDTH;
-            gameState->powerups[i].height = POWERUP_HEIGHT;
-            gameState->powerups[i].speed = 60.0f;
-            gameState->powerups[i].type = (PowerupType)(rng_u32() % 3u);
-            gameState->powerups[i].x = SCREEN_WIDTH - (float)(rng_u32() % (SCREEN_WIDTH / 3));
-            gameState->powerups[i].y = (float)(rng_u32() % (SCREEN_HEIGHT - POWERUP_HEIGHT)) + POWERUP_HEIGHT / 2.0f;
-        } else {
-            gameState->powerups[i].active = false;
+            exMax = SCREEN_WIDTH - gameState->enemies.width[i] / 2.0f;
+            gameState->enemies.x[i] = exMin + (float)rng_range((uint32_t)(exMax - exMin + 1.0f));
         }
+        float eyMin = gameState->enemies.height[i] / 2.0f;
+        float eyMax = SCREEN_HEIGHT - gameState->enemies.height[i];
+        gameState->enemies.y[i] = eyMin + (float)rng_range((uint32_t)(eyMax - eyMin + 1.0f));
     }
 
-    for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-        if (i < targetExplosions) {
-            gameState->explosions[i].active = true;
-            gameState->explosions[i].width = 24.0f;
-            gameState->explosions[i].height = 24.0f;
-            gameState->explosions[i].lifespan = 0.6f;
-            gameState->explosions[i].currentLife = 0.6f * (float)(rng_u32() % 100u) / 100.0f;
-            gameState->explosions[i].persistent = true;
-            gameState->explosions[i].x = (float)(rng_u32() % SCREEN_WIDTH);
-            gameState->explosions[i].y = (float)(rng_u32() % SCREEN_HEIGHT);
-        } else {
-            gameState->explosions[i].active = false;
-            gameState->explosions[i].persistent = false;
-        }
+    gameState->powerups.count = targetPowerups;
+    for (int i = 0; i < targetPowerups; i++) {
+        gameState->powerups.active[i] = true;
+        gameState->powerups.width[i] = POWERUP_WIDTH;
+        gameState->powerups.height[i] = POWERUP_HEIGHT;
+        gameState->powerups.speed[i] = 60.0f;
+        gameState->powerups.type[i] = (PowerupType)rng_range(3u);
+    }
+    fillColumnUniform(gameState->powerups.x, targetPowerups, SCREEN_WIDTH / 3, SCREEN_WIDTH, -1.0f);
+    fillColumnUniform(gameState->powerups.y, targetPowerups, SCREEN_HEIGHT - POWERUP_HEIGHT,
+                      POWERUP_HEIGHT / 2.0f, 1.0f);
+
+    gameState->explosions.count = targetExplosions;
+    for (int i = 0; i < targetExplosions; i++) {
+        gameState->explosions.active[i] = true;
+        gameState->explosions.width[i] = 24.0f;
+        gameState->explosions.height[i] = 24.0f;
+        gameState->explosions.lifespan[i] = 0.6f;
+        gameState->explosions.persistent[i] = true;
     }
+    fillColumnUniform(gameState->explosions.currentLife, targetExplosions, 100u, 0.0f, 0.6f / 100.0f);
+    fillColumnUniform(gameState->explosions.x, targetExplosions, SCREEN_WIDTH, 0.0f, 1.0f);
+    fillColumnUniform(gameState->explosions.y, targetExplosions, SCREEN_HEIGHT, 0.0f, 1.0f);
+    gameState->explosions.recycleCount = -1;
+
+    gameSnapInterpolation(gameState);
 }
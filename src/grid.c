@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "grid.h"
+
+static int clampInt(int v, int min, int max) {
+    if (v < min) return min;
+    if (v > max) return max;
+    return v;
+}
+
+GridSpan gridSpan(float minX, float minY, float maxX, float maxY) {
+    GridSpan span;
+    span.colStart = clampInt((int)(minX / GRID_CELL_SIZE), 0, GRID_COLS - 1);
+    span.colEnd   = clampInt((int)(maxX / GRID_CELL_SIZE), 0, GRID_COLS - 1);
+    span.rowStart = clampInt((int)(minY / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
+    span.rowEnd   = clampInt((int)(maxY / GRID_CELL_SIZE), 0, GRID_ROWS - 1);
+    return span;
+}
+
+// All per-entry columns live in one block. The contents are rebuilt every
+// frame, so growing does not need to preserve them.
+static void reserveEntries(CollisionGrid* grid, int needed) {
+    if (needed <= grid->entryCapacity) {
+        return;
+    }
+
+    int capacity = grid->entryCapacity > 0 ? grid->entryCapacity : 1024;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    free(grid->items);
+    size_t bytes = (size_t)capacity * (sizeof(int) + 4 * sizeof(float));
+    char* block = malloc(bytes);
+    if (!block) {
+        printf("Failed to allocate collision grid (%d entries)\n", capacity);
+        exit(EXIT_FAILURE);
+    }
+
+    grid->items = (int*)block;
+    grid->minX = (float*)(grid->items + capacity);
+    grid->minY = grid->minX + capacity;
+    grid->maxX = grid->minY + capacity;
+    grid->maxY = grid->maxX + capacity;
+    grid->entryCapacity = capacity;
+}
+
+void gridBuild(CollisionGrid* grid, const float* minX, const float* minY,
+               const float* maxX, const float* maxY, int n) {
+    int* cellStart = grid->cellStart;
+    for (int k = 0; k <= GRID_CELLS; k++) {
+        cellStart[k] = 0;
+    }
+
+    // Count into cellStart[k + 1] so the prefix sum below leaves each cell's
+    // first offset in cellStart[k].
+    for (int i = 0; i < n; i++) {
+        GridSpan s = gridSpan(minX[i], minY[i], maxX[i], maxY[i]);
+        for (int r = s.rowStart; r <= s.rowEnd; r++) {
+            for (int c = s.colStart; c <= s.colEnd; c++) {
+                cellStart[GRID_CELL(r, c) + 1]++;
+            }
+        }
+    }
+
+    for (int k = 0; k < GRID_CELLS; k++) {
+        cellStart[k + 1] += cellStart[k];
+    }
+
+    reserveEntries(grid, cellStart[GRID_CELLS]);
+
+    int cursor[GRID_CELLS];
+    for (int k = 0; k < GRID_CELLS; k++) {
+        cursor[k] = cellStart[k];
+    }
+
+    for (int i = 0; i < n; i++) {
+        GridSpan s = gridSpan(minX[i], minY[i], maxX[i], maxY[i]);
+        for (int r = s.rowStart; r <= s.rowEnd; r++) {
+            for (int c = s.colStart; c <= s.colEnd; c++) {
+                int e = cursor[GRID_CELL(r, c)]++;
+                grid->items[e] = i;
+                grid->minX[e] = minX[i];
+                grid->minY[e] = minY[i];
+                grid->maxX[e] = maxX[i];
+                grid->maxY[e] = maxY[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,254 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "jobs.h"
+#include "trace.h"
+
+// Both sides of a parallel-for spin this many times before falling asleep on
+// a condition variable. updateGame issues several back to back, so a short
+// spin saves most wake-ups, while sleeping keeps oversubscribed machines
+// (more threads than free cores) from burning whole time slices.
+#define JOBS_SPIN_LIMIT 64
+
+// A thread's remaining chunks [begin, end), packed as (begin << 32) | end so
+// the owner taking from the front and thieves taking from the back both
+// update it with a single compare-and-swap. Padded to its own cache line.
+typedef struct {
+    uint64_t range;
+    char pad[64 - sizeof(uint64_t)];
+} ChunkQueue;
+
+static ChunkQueue queues[JOBS_MAX_THREADS];
+static pthread_t workers[JOBS_MAX_THREADS];
+static int threadCount = 1;
+static __thread int threadIndex;
+
+static pthread_mutex_t wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wakeCond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t doneCond = PTHREAD_COND_INITIALIZER;
+static unsigned generation;
+// Generation current when the workers were started. A worker may first run
+// after the first parallel-for has been published, so it cannot read this
+// itself.
+static unsigned spawnGeneration;
+static bool quitting;
+static int busyWorkers;
+
+static JobRangeFn jobFn;
+static void* jobCtx;
+static int jobCount;
+static int jobGrain;
+
+static uint64_t packRange(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+static bool popFront(ChunkQueue* q, int* chunk) {
+    uint64_t r = __atomic_load_n(&q->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t begin = (uint32_t)(r >> 32);
+        uint32_t end = (uint32_t)r;
+        if (begin >= end) {
+            return false;
+        }
+        if (__atomic_compare_exchange_n(&q->range, &r, packRange(begin + 1, end), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *chunk = (int)begin;
+            return true;
+        }
+    }
+}
+
+static bool stealHalf(ChunkQueue* q, uint32_t* stolenBegin, uint32_t* stolenEnd) {
+    uint64_t r = __atomic_load_n(&q->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t begin = (uint32_t)(r >> 32);
+        uint32_t end = (uint32_t)r;
+        if (begin >= end) {
+            return false;
+        }
+        uint32_t split = end - (end - begin + 1) / 2;
+        if (__atomic_compare_exchange_n(&q->range, &r, packRange(begin, split), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *stolenBegin = split;
+            *stolenEnd = end;
+            return true;
+        }
+    }
+}
+
+static void runChunk(int chunk) {
+    int begin = chunk * jobGrain;
+    int end = begin + jobGrain;
+    if (end > jobCount) {
+        end = jobCount;
+    }
+    jobFn(jobCtx, begin, end);
+}
+
+static void drainQueues(int self) {
+    ChunkQueue* own = &queues[self];
+    for (;;) {
+        int chunk;
+        while (popFront(own, &chunk)) {
+            runChunk(chunk);
+        }
+
+        // Out of local work: take half of the first non-empty queue found. A
+        // stolen range never contains chunks that were already handed out,
+        // so publishing it with a plain store cannot be confused with an
+        // older value of this queue.
+        bool stole = false;
+        for (int k = 1; k < threadCount && !stole; k++) {
+            uint32_t begin, end;
+            if (stealHalf(&queues[(self + k) % threadCount], &begin, &end)) {
+                __atomic_store_n(&own->range, packRange(begin, end), __ATOMIC_RELEASE);
+                stole = true;
+            }
+        }
+        if (!stole) {
+            return;
+        }
+    }
+}
+
+static unsigned waitForWork(unsigned seen) {
+    for (int spin = 0; spin < JOBS_SPIN_LIMIT; spin++) {
+        unsigned current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+        if (current != seen) {
+            return current;
+        }
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&wakeMutex);
+    while (__atomic_load_n(&generation, __ATOMIC_ACQUIRE) == seen) {
+        pthread_cond_wait(&wakeCond, &wakeMutex);
+    }
+    unsigned current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+    pthread_mutex_unlock(&wakeMutex);
+    return current;
+}
+
+static void* workerMain(void* arg) {
+    int self = (int)(intptr_t)arg;
+    unsigned seen = spawnGeneration;
+    threadIndex = self;
+    TRACE_THREAD_NAME("worker");
+
+    for (;;) {
+        seen = waitForWork(seen);
+        if (__atomic_load_n(&quitting, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+        drainQueues(self);
+        if (__atomic_sub_fetch(&busyWorkers, 1, __ATOMIC_ACQ_REL) == 0) {
+            pthread_mutex_lock(&wakeMutex);
+            pthread_cond_signal(&doneCond);
+            pthread_mutex_unlock(&wakeMutex);
+        }
+    }
+}
+
+static void publish(void) {
+    pthread_mutex_lock(&wakeMutex);
+    __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&wakeCond);
+    pthread_mutex_unlock(&wakeMutex);
+}
+
+bool jobsInit(int count) {
+    jobsShutdown();
+
+    if (count < 1) count = 1;
+    if (count > JOBS_MAX_THREADS) count = JOBS_MAX_THREADS;
+
+    __atomic_store_n(&quitting, false, __ATOMIC_RELEASE);
+    spawnGeneration = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+    threadCount = 1;
+    for (int t = 1; t < count; t++) {
+        if (pthread_create(&workers[t], NULL, workerMain, (void*)(intptr_t)t) != 0) {
+            printf("Failed to start worker thread %d\n", t);
+            jobsShutdown();
+            return false;
+        }
+        threadCount = t + 1;
+    }
+    return true;
+}
+
+void jobsShutdown(void) {
+    if (threadCount <= 1) {
+        return;
+    }
+
+    __atomic_store_n(&quitting, true, __ATOMIC_RELEASE);
+    publish();
+    for (int t = 1; t < threadCount; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    threadCount = 1;
+}
+
+int jobsThreadCount(void) {
+    return threadCount;
+}
+
+int jobsThreadIndex(void) {
+    return threadIndex;
+}
+
+int jobsHardwareThreads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+void jobsParallelFor(int count, int grain, JobRangeFn fn, void* ctx) {
+    if (count <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    int chunks = (count + grain - 1) / grain;
+    if (threadCount <= 1 || chunks == 1) {
+        for (int c = 0; c < chunks; c++) {
+            int begin = c * grain;
+            fn(ctx, begin, begin + grain < count ? begin + grain : count);
+        }
+        return;
+    }
+
+    jobFn = fn;
+    jobCtx = ctx;
+    jobCount = count;
+    jobGrain = grain;
+    for (int t = 0; t < threadCount; t++) {
+        uint32_t begin = (uint32_t)((long)chunks * t / threadCount);
+        uint32_t end = (uint32_t)((long)chunks * (t + 1) / threadCount);
+        __atomic_store_n(&queues[t].range, packRange(begin, end), __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&busyWorkers, threadCount - 1, __ATOMIC_RELAXED);
+
+    publish();
+    drainQueues(0);
+
+    for (int spin = 0; spin < JOBS_SPIN_LIMIT; spin++) {
+        if (__atomic_load_n(&busyWorkers, __ATOMIC_ACQUIRE) == 0) {
+            return;
+        }
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&wakeMutex);
+    while (__atomic_load_n(&busyWorkers, __ATOMIC_ACQUIRE) > 0) {
+        pthread_cond_wait(&doneCond, &wakeMutex);
+    }
+    pthread_mutex_unlock(&wakeMutex);
+}
@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "kernels.h"
+
+static int cullScalar(float* x, const float* y, const float* speed,
+                      const float* width, const float* height, int start, int n,
+                      float scale, float fieldWidth, float fieldHeight,
+                      unsigned cullFlags, int* outIdx) {
+    int count = 0;
+    for (int i = start; i < n; i++) {
+        x[i] += speed[i] * scale;
+
+        bool out = false;
+        if ((cullFlags & CULL_LEFT) && x[i] < -width[i]) out = true;
+        if ((cullFlags & CULL_RIGHT) && x[i] > fieldWidth + width[i]) out = true;
+        if ((cullFlags & CULL_VERTICAL) && (y[i] < -height[i] || y[i] > fieldHeight + height[i])) out = true;
+        if (out) {
+            outIdx[count++] = i;
+        }
+    }
+    return count;
+}
+
+static int overlapScalar(float minX, float minY, float maxX, float maxY,
+                         const float* candMinX, const float* candMinY,
+                         const float* candMaxX, const float* candMaxY,
+                         int start, int n, int* outIdx) {
+    int count = 0;
+    for (int i = start; i < n; i++) {
+        if (minX < candMaxX[i] && maxX > candMinX[i] &&
+            minY < candMaxY[i] && maxY > candMinY[i]) {
+            outIdx[count++] = i;
+        }
+    }
+    return count;
+}
+
+#if defined(__AVX__)
+
+int integrateProjectiles(float* x, const float* y, const float* speed,
+                         const float* width, const float* height, int n,
+                         float scale, float fieldWidth, float fieldHeight,
+                         unsigned cullFlags, int* outIdx) {
+    const __m256 vScale = _mm256_set1_ps(scale);
+    const __m256 vFieldW = _mm256_set1_ps(fieldWidth);
+    const __m256 vFieldH = _mm256_set1_ps(fieldHeight);
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 enLeft = _mm256_castsi256_ps(_mm256_set1_epi32((cullFlags & CULL_LEFT) ? -1 : 0));
+    const __m256 enRight = _mm256_castsi256_ps(_mm256_set1_epi32((cullFlags & CULL_RIGHT) ? -1 : 0));
+    const __m256 enVert = _mm256_castsi256_ps(_mm256_set1_epi32((cullFlags & CULL_VERTICAL) ? -1 : 0));
+
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vx = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(speed + i), vScale));
+        _mm256_storeu_ps(x + i, vx);
+
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vw = _mm256_loadu_ps(width + i);
+        __m256 vh = _mm256_loadu_ps(height + i);
+
+        __m256 left = _mm256_cmp_ps(vx, _mm256_sub_ps(vZero, vw), _CMP_LT_OQ);
+        __m256 right = _mm256_cmp_ps(vx, _mm256_add_ps(vFieldW, vw), _CMP_GT_OQ);
+        __m256 vert = _mm256_or_ps(_mm256_cmp_ps(vy, _mm256_sub_ps(vZero, vh), _CMP_LT_OQ),
+                                   _mm256_cmp_ps(vy, _mm256_add_ps(vFieldH, vh), _CMP_GT_OQ));
+        __m256 out = _mm256_or_ps(_mm256_and_ps(left, enLeft),
+                                  _mm256_or_ps(_mm256_and_ps(right, enRight), _mm256_and_ps(vert, enVert)));
+
+        unsigned mask = (unsigned)_mm256_movemask_ps(out);
+        while (mask) {
+            outIdx[count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return count + cullScalar(x, y, speed, width, height, i, n, scale, fieldWidth, fieldHeight,
+                              cullFlags, outIdx + count);
+}
+
+int overlapBoxes(float minX, float minY, float maxX, float maxY,
+                 const float* candMinX, const float* candMinY,
+                 const float* candMaxX, const float* candMaxY,
+                 int n, int* outIdx) {
+    const __m256 vMinX = _mm256_set1_ps(minX);
+    const __m256 vMinY = _mm256_set1_ps(minY);
+    const __m256 vMaxX = _mm256_set1_ps(maxX);
+    const __m256 vMaxY = _mm256_set1_ps(maxY);
+
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 hit = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(vMinX, _mm256_loadu_ps(candMaxX + i), _CMP_LT_OQ),
+                          _mm256_cmp_ps(vMaxX, _mm256_loadu_ps(candMinX + i), _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(vMinY, _mm256_loadu_ps(candMaxY + i), _CMP_LT_OQ),
+                          _mm256_cmp_ps(vMaxY, _mm256_loadu_ps(candMinY + i), _CMP_GT_OQ)));
+
+        unsigned mask = (unsigned)_mm256_movemask_ps(hit);
+        while (mask) {
+            outIdx[count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return count + overlapScalar(minX, minY, maxX, maxY, candMinX, candMinY, candMaxX, candMaxY,
+                                 i, n, outIdx + count);
+}
+
+#elif defined(__SSE2__)
+
+int integrateProjectiles(float* x, const float* y, const float* speed,
+                         const float* width, const float* height, int n,
+                         float scale, float fieldWidth, float fieldHeight,
+                         unsigned cullFlags, int* outIdx) {
+    const __m128 vScale = _mm_set1_ps(scale);
+    const __m128 vFieldW = _mm_set1_ps(fieldWidth);
+    const __m128 vFieldH = _mm_set1_ps(fieldHeight);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 enLeft = _mm_castsi128_ps(_mm_set1_epi32((cullFlags & CULL_LEFT) ? -1 : 0));
+    const __m128 enRight = _mm_castsi128_ps(_mm_set1_epi32((cullFlags & CULL_RIGHT) ? -1 : 0));
+    const __m128 enVert = _mm_castsi128_ps(_mm_set1_epi32((cullFlags & CULL_VERTICAL) ? -1 : 0));
+
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(speed + i), vScale));
+        _mm_storeu_ps(x + i, vx);
+
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vw = _mm_loadu_ps(width + i);
+        __m128 vh = _mm_loadu_ps(height + i);
+
+        __m128 left = _mm_cmplt_ps(vx, _mm_sub_ps(vZero, vw));
+        __m128 right = _mm_cmpgt_ps(vx, _mm_add_ps(vFieldW, vw));
+        __m128 vert = _mm_or_ps(_mm_cmplt_ps(vy, _mm_sub_ps(vZero, vh)),
+                                _mm_cmpgt_ps(vy, _mm_add_ps(vFieldH, vh)));
+        __m128 out = _mm_or_ps(_mm_and_ps(left, enLeft),
+                               _mm_or_ps(_mm_and_ps(right, enRight), _mm_and_ps(vert, enVert)));
+
+        unsigned mask = (unsigned)_mm_movemask_ps(out);
+        while (mask) {
+            outIdx[count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return count + cullScalar(x, y, speed, width, height, i, n, scale, fieldWidth, fieldHeight,
+                              cullFlags, outIdx + count);
+}
+
+int overlapBoxes(float minX, float minY, float maxX, float maxY,
+                 const float* candMinX, const float* candMinY,
+                 const float* candMaxX, const float* candMaxY,
+                 int n, int* outIdx) {
+    const __m128 vMinX = _mm_set1_ps(minX);
+    const __m128 vMinY = _mm_set1_ps(minY);
+    const __m128 vMaxX = _mm_set1_ps(maxX);
+    const __m128 vMaxY = _mm_set1_ps(maxY);
+
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 hit = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(vMinX, _mm_loadu_ps(candMaxX + i)),
+                       _mm_cmpgt_ps(vMaxX, _mm_loadu_ps(candMinX + i))),
+            _mm_and_ps(_mm_cmplt_ps(vMinY, _mm_loadu_ps(candMaxY + i)),
+                       _mm_cmpgt_ps(vMaxY, _mm_loadu_ps(candMinY + i))));
+
+        unsigned mask = (unsigned)_mm_movemask_ps(hit);
+        while (mask) {
+            outIdx[count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return count + overlapScalar(minX, minY, maxX, maxY, candMinX, candMinY, candMaxX, candMaxY,
+                                 i, n, outIdx + count);
+}
+
+#else
+
+int integrateProjectiles(float* x, const float* y, const float* speed,
+                         const float* width, const float* height, int n,
+                         float scale, float fieldWidth, float fieldHeight,
+                         unsigned cullFlags, int* outIdx) {
+    return cullScalar(x, y, speed, width, height, 0, n, scale, fieldWidth, fieldHeight,
+                      cullFlags, outIdx);
+}
+
+int overlapBoxes(float minX, float minY, float maxX, float maxY,
+                 const float* candMinX, const float* candMinY,
+                 const float* candMaxX, const float* candMaxY,
+                 int n, int* outIdx) {
+    return overlapScalar(minX, minY, maxX, maxY, candMinX, candMinY, candMaxX, candMaxY, 0, n, outIdx);
+}
+
+#endif
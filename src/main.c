@@ -8,10 +8,20 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "autopilot.h"
+#include "fixedstep.h"
 #include "game.h"
+#include "jobs.h"
+#include "pipeline.h"
 #include "renderer.h"
+#include "replay.h"
+#include "report.h"
 #include "resources.h"
 #include "rng.h"
+#include "savestate.h"
+#include "soak.h"
+#include "statehash.h"
+#include "trace.h"
 
 #define WINDOW_WIDTH 960
 #define WINDOW_HEIGHT 640
@@ -24,29 +34,89 @@ static bool keyDownPressed = false;
 static bool keyLeftPressed = false;
 static bool keyRightPressed = false;
 
-void updatePlayerDirection(GameState* gameState) {
+// Set while the simulation thread owns gameState; input is then queued
+// through the pipeline instead of being applied directly.
+static bool pipelineActive = false;
+
+// Serial mode: key presses collect here and are applied, and recorded, as
+// one TickInput right before the next tick.
+static TickInput pendingInput = { DIR_NONE, 0, false };
+static ReplayRecorder recorder;
+
+// F5 saves the game here (--save-state); serial play only.
+static const char* saveStatePath = NULL;
+
+// While replaying, the replay is the only input source.
+static bool replayActive = false;
+static Replay replay;
+
+// --soak: the autopilot plays, and a new game starts whenever one ends.
+static bool soakActive = false;
+
+static void updatePlayerDirection(void) {
+    Direction direction;
     if (keyUpPressed && keyLeftPressed) {
-        gameState->player.direction = DIR_UP_LEFT;
+        direction = DIR_UP_LEFT;
     } else if (keyUpPressed && keyRightPressed) {
-        gameState->player.direction = DIR_UP_RIGHT;
+        direction = DIR_UP_RIGHT;
     } else if (keyDownPressed && keyLeftPressed) {
-        gameState->player.direction = DIR_DOWN_LEFT;
+        direction = DIR_DOWN_LEFT;
     } else if (keyDownPressed && keyRightPressed) {
-        gameState->player.direction = DIR_DOWN_RIGHT;
+        direction = DIR_DOWN_RIGHT;
     } else if (keyUpPressed) {
-        gameState->player.direction = DIR_UP;
+        direction = DIR_UP;
     } else if (keyDownPressed) {
-        gameState->player.direction = DIR_DOWN;
+        direction = DIR_DOWN;
     } else if (keyLeftPressed) {
-        gameState->player.direction = DIR_LEFT;
+        direction = DIR_LEFT;
     } else if (keyRightPressed) {
-        gameState->player.direction = DIR_RIGHT;
+        direction = DIR_RIGHT;
+    } else {
+        direction = DIR_NONE;
+    }
+
+    if (pipelineActive) {
+        pipelineSetDirection(direction);
     } else {
-        gameState->player.direction = DIR_NONE;
+        pendingInput.direction = direction;
     }
 }
 
+// The input for the coming tick. False once a replay has run out.
+static bool take_tick_input(TickInput* input) {
+    if (replayActive) {
+        return replayNext(&replay, input);
+    }
+    if (soakActive) {
+        autopilotInput(&gameState, input);
+        return true;
+    }
+    *input = pendingInput;
+    pendingInput.fires = 0;
+    pendingInput.quit = false;
+    return true;
+}
+
+// A new game with the same broad-phase settings. Mismatches found so far
+// still count towards the exit status.
+static void restart_game(void) {
+    BroadPhaseKind broadPhase = gameState.broadPhase;
+    bool verifyBroadPhase = gameState.verifyBroadPhase;
+    int mismatches = gameState.broadPhaseMismatches;
+    initGame(&gameState);
+    gameState.broadPhase = broadPhase;
+    gameState.verifyBroadPhase = verifyBroadPhase;
+    gameState.broadPhaseMismatches = mismatches;
+}
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (replayActive || soakActive) {
+        if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        return;
+    }
+
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         switch (key) {
             case GLFW_KEY_UP:
@@ -62,14 +132,28 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 keyLeftPressed = true;
                 break;
             case GLFW_KEY_SPACE:
-                fireBullet(&gameState);
+                if (pipelineActive) {
+                    pipelineQueueFire();
+                } else {
+                    pendingInput.fires++;
+                }
                 break;
             case GLFW_KEY_ESCAPE:
-                gameState.gameOver = true;
+                if (pipelineActive) {
+                    pipelineQueueQuit();
+                } else {
+                    pendingInput.quit = true;
+                }
+                break;
+            case GLFW_KEY_F5:
+                if (action == GLFW_PRESS && saveStatePath && !pipelineActive &&
+                    saveState(&gameState, saveStatePath)) {
+                    printf("Saved state to %s\n", saveStatePath);
+                }
                 break;
             case GLFW_KEY_ENTER:
-                if (gameState.gameOver) {
-                    initGame(&gameState);
+                if (!pipelineActive && gameState.gameOver) {
+                    restart_game();
                 }
                 break;
         }
@@ -90,7 +174,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
     }
     
-    updatePlayerDirection(&gameState);
+    updatePlayerDirection();
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
@@ -136,9 +220,76 @@ bool initOpenGL() {
 }
 
 #define MAX_BENCH_FRAMES 300000
+#define MAX_BENCH_TICKS 300000
+
+// Benchmark runs default to a fixed seed so that every run simulates the
+// same workload; normal play is seeded from the clock unless --seed is set.
+#define DEFAULT_BENCH_SEED 12345u
 
 static void print_usage(const char* prog) {
-    printf("Usage: %s [--benchmark] [--duration SEC] [--warmup SEC] [--density 0-100]\n", prog);
+    printf("Usage: %s [--benchmark] [--duration SEC] [--warmup SEC] [--density 0-100]\n"
+           "          [--broadphase grid|sap|bvh] [--verify-broadphase] [--threads N (0 = all cores)]\n"
+           "          [--pipeline] [--trace FILE.json] [--report json|csv] [--report-file PATH]\n"
+           "          [--baseline FILE.json] [--tolerance PCT] [--seed N]\n"
+           "          [--hash-log FILE | --hash-check FILE] [--record FILE | --replay FILE]\n"
+           "          [--load-state FILE] [--save-state FILE (saved with F5)]\n"
+           "          [--capacity bullets=N,enemies=N,enemyBullets=N,powerups=N,explosions=N]\n"
+           "          [--max-substeps N (ticks per frame when behind, 0 = no cap)]\n"
+           "          [--soak MINUTES] [--soak-log FILE.csv]\n", prog);
+}
+
+#define SCALING_TICKS 600
+
+static void hash_tick(void* ctx, const GameState* gameState) {
+    stateHashLogTick((StateHashLog*)ctx, gameState);
+}
+
+// Stops recording and writes the trace, if one was requested. Called once
+// the simulation thread has been joined so no zone is still open elsewhere.
+static void finish_trace(const char* path, FILE* out) {
+    if (!path) {
+        return;
+    }
+    traceStop();
+    traceWrite(path, out);
+}
+
+// Replays the same benchmark scene (or loaded state) with the simulation
+// alone (no rendering) at 1, 2, 4, ... up to maxThreads and prints the time
+// per tick.
+static void report_thread_scaling(FILE* out, int maxThreads, int density, uint32_t seed,
+                                  const char* statePath, BroadPhaseKind broadPhase,
+                                  const GameCapacities* capacities) {
+    static GameState scratch;
+    const float fixedDt = 1.0f / 60.0f;
+    double baseMs = 0.0;
+
+    gameAllocate(&scratch, capacities);
+
+    fprintf(out, "\nThread scaling (simulation only, %d ticks)\n", SCALING_TICKS);
+    int threads = 1;
+    for (;;) {
+        jobsInit(threads);
+        rng_seed(seed);
+        initGame(&scratch);
+        scratch.broadPhase = broadPhase;
+        if (!statePath || !loadState(&scratch, statePath)) {
+            prepareBenchmarkScene(&scratch, density);
+        }
+
+        double start = glfwGetTime();
+        for (int t = 0; t < SCALING_TICKS; t++) {
+            updateGame(&scratch, fixedDt);
+        }
+        double ms = (glfwGetTime() - start) * 1000.0 / SCALING_TICKS;
+        if (threads == 1) baseMs = ms;
+
+        fprintf(out, "Threads %2d: %.3f ms/tick, speedup %.2fx\n",
+                jobsThreadCount(), ms, (ms > 0.0) ? baseMs / ms : 0.0);
+
+        if (threads >= maxThreads) break;
+        threads = (threads * 2 < maxThreads) ? threads * 2 : maxThreads;
+    }
 }
 
 static int cmp_desc_double(const void* a, const void* b) {
@@ -153,6 +304,28 @@ int main(int argc, char** argv) {
     double optDuration = 10.0;
     double optWarmup = 1.0;
     int optDensity = 100;
+    BroadPhaseKind optBroadPhase = BROADPHASE_GRID;
+    bool optVerifyBroadPhase = false;
+    int optThreads = 1;
+    bool optPipeline = false;
+    const char* optTrace = NULL;
+    ReportFormat optReport = REPORT_NONE;
+    const char* optReportFile = NULL;
+    const char* optBaseline = NULL;
+    double optTolerance = 10.0;
+    bool optSeedSet = false;
+    uint32_t optSeed = 0;
+    const char* optHashFile = NULL;
+    bool optHashCheck = false;
+    const char* optRecord = NULL;
+    const char* optReplay = NULL;
+    const char* optLoadState = NULL;
+    GameCapacities optCapacities;
+    gameCapacitiesDefault(&optCapacities);
+    int optMaxSubsteps = DEFAULT_MAX_SUBSTEPS;
+    double optSoak = 0.0;
+    int optSoakTicks = 0;
+    const char* optSoakLog = NULL;
 
     for (int i = 1; i < argc; i++) {
 
@@ -164,13 +337,103 @@ int main(int argc, char** argv) {
             optWarmup = atof(argv[++i]);
         } else if (strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
             optDensity = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc) {
+            if (!broadPhaseFromName(argv[++i], &optBroadPhase)) {
+                printf("Unknown broad phase: %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--verify-broadphase") == 0) {
+            optVerifyBroadPhase = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            optThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            optPipeline = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            optTrace = argv[++i];
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            if (!reportFormatFromName(argv[++i], &optReport)) {
+                printf("Unknown report format: %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--report-file") == 0 && i + 1 < argc) {
+            optReportFile = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            optBaseline = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            optTolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            optSeed = (uint32_t)strtoul(argv[++i], NULL, 10);
+            optSeedSet = true;
+        } else if (strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            optHashFile = argv[++i];
+            optHashCheck = false;
+        } else if (strcmp(argv[i], "--hash-check") == 0 && i + 1 < argc) {
+            optHashFile = argv[++i];
+            optHashCheck = true;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            optRecord = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            optReplay = argv[++i];
+        } else if (strcmp(argv[i], "--load-state") == 0 && i + 1 < argc) {
+            optLoadState = argv[++i];
+        } else if (strcmp(argv[i], "--save-state") == 0 && i + 1 < argc) {
+            saveStatePath = argv[++i];
+        } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            if (!gameCapacitiesParse(&optCapacities, argv[++i])) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--max-substeps") == 0 && i + 1 < argc) {
+            optMaxSubsteps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            if (!soakParseMinutes(argv[++i], &optSoak, &optSoakTicks)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--soak-log") == 0 && i + 1 < argc) {
+            optSoakLog = argv[++i];
         } else {
             printf("Unknown option: %s\n", argv[i]);
             return 1;
         }
     }
 
-    rng_seed((uint32_t)time(NULL));
+    if ((optRecord || optReplay) && optBenchmark) {
+        printf("--record and --replay cannot be combined with --benchmark\n");
+        return 1;
+    }
+    if ((optRecord || optReplay) && optLoadState) {
+        printf("--record and --replay start from a new game and cannot be combined with --load-state\n");
+        return 1;
+    }
+    if (optSoak > 0.0 && (optBenchmark || optRecord || optReplay || optLoadState)) {
+        // A soak restarts the game on game over, which a replay cannot
+        // follow.
+        printf("--soak plays new games and cannot be combined with --benchmark, --record, --replay or --load-state\n");
+        return 1;
+    }
+    if (optSoak > 0.0 && optPipeline) {
+        printf("Soak runs the serial loop; ignoring --pipeline\n");
+        optPipeline = false;
+    }
+    if ((optRecord || optReplay) && optPipeline) {
+        // Input is only tick-exact in the serial loop.
+        printf("Recording and replay run the serial loop; ignoring --pipeline\n");
+        optPipeline = false;
+    }
+
+    uint32_t seed = optSeedSet ? optSeed : (optBenchmark ? DEFAULT_BENCH_SEED : (uint32_t)time(NULL));
+    if (optReplay) {
+        if (!replayLoad(&replay, optReplay)) {
+            return 1;
+        }
+        replayActive = true;
+        seed = replay.seed;
+        printf("Replaying %s: %u ticks, seed %u\n", optReplay, replay.ticks, seed);
+    }
+    rng_seed(seed);
 
     if (!initOpenGL()) {
         return -1;
@@ -189,30 +452,145 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (optThreads <= 0) optThreads = jobsHardwareThreads();
+    jobsInit(optThreads);
+
+    // A report on stdout must be the only thing there; the human-readable
+    // results, and what the hash log, replay and trace have to say, move to
+    // stderr.
+    FILE* text = (optReport != REPORT_NONE && !optReportFile) ? stderr : stdout;
+
+    gameAllocate(&gameState, &optCapacities);
     initGame(&gameState);
+    gameState.broadPhase = optBroadPhase;
+    gameState.verifyBroadPhase = optVerifyBroadPhase;
+    if (optLoadState) {
+        if (!loadState(&gameState, optLoadState)) {
+            jobsShutdown();
+            destroyRenderer();
+            glfwTerminate();
+            return 1;
+        }
+        seed = rng_current_seed();
+        fprintf(text, "Loaded state from %s\n", optLoadState);
+    }
+
+    // Logged or checked after every tick, on whichever thread runs them.
+    static StateHashLog hashLog;
+    if (optHashFile && !stateHashLogOpen(&hashLog, optHashFile, optHashCheck, seed, text)) {
+        jobsShutdown();
+        destroyRenderer();
+        glfwTerminate();
+        return 1;
+    }
+    pipelineOnTick(optHashFile ? hash_tick : NULL, &hashLog);
+
+    if (optRecord && !replayRecordOpen(&recorder, optRecord, seed)) {
+        stateHashLogClose(&hashLog);
+        jobsShutdown();
+        destroyRenderer();
+        glfwTerminate();
+        return 1;
+    }
+
+    static SoakLog soak;
+    unsigned soakTicks = (unsigned)optSoakTicks;
+    if (optSoak > 0.0) {
+        if (!soakOpen(&soak, optSoakLog, text)) {
+            stateHashLogClose(&hashLog);
+            jobsShutdown();
+            destroyRenderer();
+            glfwTerminate();
+            return 1;
+        }
+        soakActive = true;
+        fprintf(text, "Soak: %.1f min of autopilot play, seed %u\n", optSoak, seed);
+    }
+
+    TRACE_THREAD_NAME("main");
+    if (optTrace && !traceStart()) {
+        fprintf(text, "Tracing is not compiled in (rebuild with TRACE=1); ignoring --trace\n");
+        optTrace = NULL;
+    }
 
     if (!optBenchmark) {
-        double lastTime = glfwGetTime();
-        double deltaTime = 0.0;
         double frameTime = 1.0 / 60.0;
 
-        while (!glfwWindowShouldClose(window) && !gameState.gameOver) {
-            double currentTime = glfwGetTime();
-            deltaTime += currentTime - lastTime;
-            lastTime = currentTime;
+        pipelineActive = optPipeline && pipelineStart(&gameState, frameTime, optMaxSubsteps);
+        if (pipelineActive) {
+            while (!glfwWindowShouldClose(window) && pipelineRunning()) {
+                TRACE_BEGIN("frame");
+                glfwPollEvents();
+                const RenderSnapshot* snapshot = pipelineLatest();
+                renderSnapshot(snapshot, pipelineAlpha(snapshot));
+                TRACE_BEGIN("swap");
+                glfwSwapBuffers(window);
+                TRACE_END();
+                TRACE_END();
+            }
+            pipelineStop();
+            pipelineActive = false;
+        } else {
+            FixedStep step;
+            fixedStepInit(&step, frameTime, optMaxSubsteps, glfwGetTime());
+            bool inputEnded = false;
+            while (!glfwWindowShouldClose(window) && !gameState.gameOver && !inputEnded) {
+                TRACE_BEGIN("frame");
+                int due = fixedStepAdvance(&step, glfwGetTime());
 
-            glfwPollEvents();
+                glfwPollEvents();
 
-            while (deltaTime >= frameTime) {
-                updateGame(&gameState, frameTime);
-                deltaTime -= frameTime;
-            }
+                for (int t = 0; t < due; t++) {
+                    TickInput input;
+                    if (!take_tick_input(&input)) {
+                        inputEnded = true;
+                        break;
+                    }
+                    applyTickInput(&gameState, &input);
+                    replayRecordTick(&recorder, &input);
+                    double tickStart = glfwGetTime();
+                    updateGame(&gameState, frameTime);
+                    double tickSeconds = glfwGetTime() - tickStart;
+                    stateHashLogTick(&hashLog, &gameState);
+
+                    if (soakActive) {
+                        soakTick(&soak, &gameState, tickSeconds);
+                        if (gameState.gameOver) {
+                            soakGameOver(&soak, &gameState);
+                            restart_game();
+                        }
+                        if (soak.ticks >= soakTicks) {
+                            inputEnded = true;
+                            break;
+                        }
+                    }
+                }
 
-            renderGame(&gameState);
-            glfwSwapBuffers(window);
+                renderGame(&gameState, fixedStepAlpha(&step));
+                TRACE_BEGIN("swap");
+                glfwSwapBuffers(window);
+                TRACE_END();
+                TRACE_END();
+            }
         }
+        finish_trace(optTrace, text);
 
-        if (gameState.gameOver) {
+        // Before the game-over screen, where Enter restarts the game.
+        int status = 0;
+        if (optRecord && replayRecordClose(&recorder, stateHash(&gameState))) {
+            fprintf(text, "Recorded %u ticks to %s\n", recorder.ticks, optRecord);
+        }
+        if (replayActive) {
+            status = replayCheck(&replay, stateHash(&gameState), text);
+            replayFree(&replay);
+            replayActive = false;
+        } else if (soakActive) {
+            soakPrintSummary(&soak, text);
+            if (!soakClose(&soak)) {
+                status = 1;
+            }
+            soakActive = false;
+        } else if (gameState.gameOver) {
             renderGameOver(&gameState);
             glfwSwapBuffers(window);
 
@@ -221,50 +599,84 @@ int main(int argc, char** argv) {
             }
         }
 
+        if (optVerifyBroadPhase) {
+            fprintf(text, "Broad-phase mismatches (%s): %d\n",
+                    broadPhaseName(optBroadPhase), gameState.broadPhaseMismatches);
+            if (gameState.broadPhaseMismatches > 0) {
+                status = 2;
+            }
+        }
+
+        if (!stateHashLogClose(&hashLog)) {
+            status = 2;
+        }
+
+        jobsShutdown();
         destroyRenderer();
         glfwTerminate();
-        return 0;
+        return status;
     }
 
     if (optDensity < 0) optDensity = 0;
     if (optDensity > 100) optDensity = 100;
-    prepareBenchmarkScene(&gameState, optDensity);
+    if (!optLoadState) {
+        prepareBenchmarkScene(&gameState, optDensity);
+    }
 
     static double frameDurations[MAX_BENCH_FRAMES];
+    static double tickDurations[MAX_BENCH_TICKS];
     int framesCollected = 0;
+    int ticksCollected = 0;
     double sumDur = 0.0, minDur = 1e9, maxDur = 0.0;
 
     const double fixedDt = 1.0 / 60.0;
     double lastTime = glfwGetTime();
-    double accumulator = 0.0;
+    FixedStep step;
+    fixedStepInit(&step, fixedDt, optMaxSubsteps, lastTime);
 
     const double benchStart = lastTime;
     const double warmupEnd = benchStart + ((optWarmup > 0.0) ? optWarmup : 0.0);
     const double benchEnd = warmupEnd + ((optDuration > 0.0) ? optDuration : 0.0);
     double lastSwapTs = lastTime;
 
-    printf("[Benchmark] density=%d, warmup=%.2fs, duration=%.2fs\n",
-           optDensity, optWarmup, optDuration);
+    fprintf(text, "[Benchmark] density=%d, warmup=%.2fs, duration=%.2fs, threads=%d, seed=%u%s\n",
+            optDensity, optWarmup, optDuration, jobsThreadCount(), seed, optPipeline ? ", pipelined" : "");
+    pipelineLogTicks(tickDurations, MAX_BENCH_TICKS);
+    pipelineActive = optPipeline && pipelineStart(&gameState, fixedDt, optMaxSubsteps);
     while (!glfwWindowShouldClose(window)) {
-        double now = glfwGetTime();
-        accumulator += now - lastTime;
-        lastTime = now;
-
+        TRACE_BEGIN("frame");
         glfwPollEvents();
 
-        while (accumulator >= fixedDt) {
-            updateGame(&gameState, (float)fixedDt);
-            accumulator -= fixedDt;
-        }
+        if (pipelineActive) {
+            const RenderSnapshot* snapshot = pipelineLatest();
+            renderSnapshot(snapshot, pipelineAlpha(snapshot));
+        } else {
+            double now = glfwGetTime();
+            int due = fixedStepAdvance(&step, now);
+
+            bool measuring = now >= warmupEnd && now <= benchEnd;
+            for (int t = 0; t < due; t++) {
+                double tickStart = glfwGetTime();
+                updateGame(&gameState, (float)fixedDt);
+                if (measuring && ticksCollected < MAX_BENCH_TICKS) {
+                    tickDurations[ticksCollected++] = glfwGetTime() - tickStart;
+                }
+                stateHashLogTick(&hashLog, &gameState);
+            }
 
-        renderGame(&gameState);
+            renderGame(&gameState, fixedStepAlpha(&step));
+        }
+        TRACE_BEGIN("swap");
         glfwSwapBuffers(window);
+        TRACE_END();
+        TRACE_END();
 
         double afterSwap = glfwGetTime();
         double frameDur = afterSwap - lastSwapTs;
         lastSwapTs = afterSwap;
 
         if (afterSwap >= warmupEnd && afterSwap <= benchEnd) {
+            if (pipelineActive) pipelineSetTickLogging(true);
             if (framesCollected < MAX_BENCH_FRAMES) {
                 frameDurations[framesCollected++] = frameDur;
             }
@@ -276,6 +688,14 @@ int main(int argc, char** argv) {
         if (afterSwap >= benchEnd) break;
     }
 
+    if (pipelineActive) {
+        pipelineSetTickLogging(false);
+        pipelineStop();
+        pipelineActive = false;
+        ticksCollected = pipelineLoggedTicks();
+    }
+    finish_trace(optTrace, text);
+
     double elapsed = sumDur;
     double avgFps = (elapsed > 0.0) ? ((double)framesCollected / elapsed) : 0.0;
     double minFps = (maxDur > 0.0) ? (1.0 / maxDur) : 0.0;
@@ -292,15 +712,76 @@ int main(int argc, char** argv) {
         if (avgSlowDur > 0.0) p1LowFps = 1.0 / avgSlowDur;
     }
 
-    printf("\nBenchmark results\n");
-    printf("Frames: %d\n", framesCollected);
-    printf("Measured time: %.3f s\n", elapsed);
-    printf("Avg FPS: %.2f\n", avgFps);
-    printf("1%% low FPS: %.2f\n", p1LowFps);
-    printf("Min FPS: %.2f\n", minFps);
-    printf("Max FPS: %.2f\n", maxFps);
+    BenchReport report = { 0 };
+    report.tool = "space_impact --benchmark";
+    report.density = optDensity;
+    report.threads = jobsThreadCount();
+    report.seed = seed;
+    report.broadPhase = optBroadPhase;
+    report.pipelined = optPipeline;
+    report.capacities = optCapacities;
+    report.measuredSeconds = elapsed;
+    report.avgFps = avgFps;
+    report.onePercentLowFps = p1LowFps;
+    latencyStatsCompute(&report.frames, frameDurations, framesCollected);
+    latencyStatsCompute(&report.ticks, tickDurations, ticksCollected);
+    report.bullets = gameState.bullets.count;
+    report.enemies = gameState.enemies.count;
+    report.enemyBullets = gameState.enemyBullets.count;
+    report.powerups = gameState.powerups.count;
+    report.explosions = gameState.explosions.count;
+    report.score = gameState.player.score;
+
+    fprintf(text, "\nBenchmark results\n");
+    fprintf(text, "Frames: %d\n", framesCollected);
+    fprintf(text, "Measured time: %.3f s\n", elapsed);
+    fprintf(text, "Avg FPS: %.2f\n", avgFps);
+    fprintf(text, "1%% low FPS: %.2f\n", p1LowFps);
+    fprintf(text, "Min FPS: %.2f\n", minFps);
+    fprintf(text, "Max FPS: %.2f\n", maxFps);
+    fprintf(text, "Frame time (ms): p50 %.3f, p90 %.3f, p99 %.3f, p99.9 %.3f\n",
+            report.frames.p50, report.frames.p90, report.frames.p99, report.frames.p999);
+    fprintf(text, "Tick time (ms): p50 %.3f, p90 %.3f, p99 %.3f, p99.9 %.3f\n",
+            report.ticks.p50, report.ticks.p90, report.ticks.p99, report.ticks.p999);
+    if (optPipeline) {
+        fprintf(text, "Simulation thread: %u ticks, %u snapshots, max tick %.3f ms\n",
+                pipelineTicks(), pipelinePublished(), pipelineMaxTickSeconds() * 1000.0);
+    }
+    double droppedSeconds = optPipeline ? pipelineDroppedSeconds() : step.droppedSeconds;
+    if (droppedSeconds > 0.0) {
+        fprintf(text, "Time dilation: %.3f s of simulation dropped (substep cap %d)\n",
+                droppedSeconds, optMaxSubsteps);
+    }
+
+    if (optVerifyBroadPhase) {
+        fprintf(text, "Broad-phase mismatches (%s): %d\n",
+                broadPhaseName(optBroadPhase), gameState.broadPhaseMismatches);
+    }
 
+    if (jobsThreadCount() > 1) {
+        report_thread_scaling(text, jobsThreadCount(), optDensity, seed, optLoadState, optBroadPhase,
+                              &optCapacities);
+    }
+
+    int status = 0;
+    if (optVerifyBroadPhase && gameState.broadPhaseMismatches > 0) {
+        status = 2;
+    }
+    if (!stateHashLogClose(&hashLog)) {
+        status = 2;
+    }
+    if (optReport != REPORT_NONE && !reportWrite(&report, optReport, optReportFile)) {
+        status = 1;
+    }
+    if (optBaseline) {
+        int regressions = reportCompareBaseline(&report, optBaseline, optTolerance, text);
+        if (regressions != 0) {
+            status = (regressions < 0) ? 1 : 2;
+        }
+    }
+
+    jobsShutdown();
     destroyRenderer();
     glfwTerminate();
-    return 0;
+    return status;
 }
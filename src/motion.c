@@ -0,0 +1,263 @@
+#include <math.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "motion.h"
+
+#define MOTION_PI 3.14159265358979f
+#define MOTION_HALF_PI 1.57079632679490f
+#define MOTION_TWO_PI 6.28318530717959f
+#define MOTION_INV_TWO_PI 0.159154943091895f
+// 2*pi split so that k * TWO_PI_HI is exact for the k we see in practice.
+#define MOTION_TWO_PI_HI 6.28125f
+#define MOTION_TWO_PI_LO 0.00193530717958647f
+
+#define SIN_C3  -1.66666666666666667e-1f
+#define SIN_C5   8.33333333333333333e-3f
+#define SIN_C7  -1.98412698412698413e-4f
+#define SIN_C9   2.75573192239858907e-6f
+#define SIN_C11 -2.50521083854417188e-8f
+
+// ENEMY_SMALL used to add sin(phase) * 1.5 px every 60Hz tick while the phase
+// advanced 3 rad/s, i.e. a vertical speed of 90 * sin(phase) px/s. Integrating
+// that over a tick gives WOBBLE_AMPLITUDE * (cos(p0) - cos(p1)).
+#define WOBBLE_RATE 3.0f
+#define WOBBLE_AMPLITUDE 30.0f
+#define BOSS_SWEEP_RATE 1.0f
+
+float motionSin(float x) {
+    float k = (float)lrintf(x * MOTION_INV_TWO_PI);
+    float r = (x - k * MOTION_TWO_PI_HI) - k * MOTION_TWO_PI_LO;
+    float a = fabsf(r);
+    float b = MOTION_PI - a;
+    float m = (a < b) ? a : b;
+    float m2 = m * m;
+    float p = SIN_C11;
+    p = p * m2 + SIN_C9;
+    p = p * m2 + SIN_C7;
+    p = p * m2 + SIN_C5;
+    p = p * m2 + SIN_C3;
+    float s = m + m * m2 * p;
+    return (r < 0.0f) ? -s : s;
+}
+
+// Per-enemy motion shared by the scalar path and the vector tails. Must stay
+// operation-for-operation identical to the vector bodies below.
+static void moveEnemyScalar(EnemyPool* enemies, int i, float deltaTime, float fieldHeight) {
+    enemies->x[i] -= enemies->speed[i] * deltaTime;
+
+    EnemyType type = enemies->type[i];
+    if (type != ENEMY_SMALL && type != ENEMY_BOSS) {
+        return;
+    }
+
+    float p0 = enemies->movementPattern[i];
+    float p1 = p0 + ((type == ENEMY_SMALL) ? WOBBLE_RATE : BOSS_SWEEP_RATE) * deltaTime;
+    float sweep = motionSin((type == ENEMY_SMALL) ? p1 + MOTION_HALF_PI : p1);
+
+    if (type == ENEMY_SMALL) {
+        float cosP0 = motionSin(p0 + MOTION_HALF_PI);
+        enemies->y[i] += WOBBLE_AMPLITUDE * (cosP0 - sweep);
+    } else {
+        float newY = (float)(int)(fieldHeight / 2) + sweep * (float)(int)(fieldHeight / 3);
+        float minY = enemies->height[i] / 2;
+        float maxY = fieldHeight - enemies->height[i];
+        if (newY < minY) {
+            newY = minY;
+        } else if (newY > maxY) {
+            newY = maxY;
+        }
+        enemies->y[i] = newY;
+    }
+
+    if (p1 >= MOTION_TWO_PI) {
+        p1 -= MOTION_TWO_PI;
+    }
+    enemies->movementPattern[i] = p1;
+}
+
+#if defined(__AVX2__)
+
+static __m256 sinAvx(__m256 x) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 k = _mm256_cvtepi32_ps(_mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(MOTION_INV_TWO_PI))));
+    __m256 r = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(MOTION_TWO_PI_HI))),
+                             _mm256_mul_ps(k, _mm256_set1_ps(MOTION_TWO_PI_LO)));
+    __m256 a = _mm256_andnot_ps(signMask, r);
+    __m256 m = _mm256_min_ps(a, _mm256_sub_ps(_mm256_set1_ps(MOTION_PI), a));
+    __m256 m2 = _mm256_mul_ps(m, m);
+    __m256 p = _mm256_set1_ps(SIN_C11);
+    p = _mm256_add_ps(_mm256_mul_ps(p, m2), _mm256_set1_ps(SIN_C9));
+    p = _mm256_add_ps(_mm256_mul_ps(p, m2), _mm256_set1_ps(SIN_C7));
+    p = _mm256_add_ps(_mm256_mul_ps(p, m2), _mm256_set1_ps(SIN_C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, m2), _mm256_set1_ps(SIN_C3));
+    __m256 s = _mm256_add_ps(m, _mm256_mul_ps(_mm256_mul_ps(m, m2), p));
+    return _mm256_xor_ps(s, _mm256_and_ps(r, signMask));
+}
+
+void motionSinBatch(const float* x, float* out, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, sinAvx(_mm256_loadu_ps(x + i)));
+    }
+    for (; i < n; i++) {
+        out[i] = motionSin(x[i]);
+    }
+}
+
+void updateEnemyMotion(EnemyPool* enemies, int begin, int end, float deltaTime, float fieldHeight) {
+    const __m256 vDt = _mm256_set1_ps(deltaTime);
+    const __m256 vHalfPi = _mm256_set1_ps(MOTION_HALF_PI);
+    const __m256 vTwoPi = _mm256_set1_ps(MOTION_TWO_PI);
+    const __m256 vCenter = _mm256_set1_ps((float)(int)(fieldHeight / 2));
+    const __m256 vSweep = _mm256_set1_ps((float)(int)(fieldHeight / 3));
+    const __m256 vFieldH = _mm256_set1_ps(fieldHeight);
+    const __m256 vHalf = _mm256_set1_ps(0.5f);
+    const __m256 vRateSmall = _mm256_set1_ps(WOBBLE_RATE);
+    const __m256 vRateBoss = _mm256_set1_ps(BOSS_SWEEP_RATE);
+    const __m256i vSmall = _mm256_set1_epi32(ENEMY_SMALL);
+    const __m256i vBoss = _mm256_set1_epi32(ENEMY_BOSS);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(enemies->x + i);
+        x = _mm256_sub_ps(x, _mm256_mul_ps(_mm256_loadu_ps(enemies->speed + i), vDt));
+        _mm256_storeu_ps(enemies->x + i, x);
+
+        // EnemyType is an int-sized enum, so eight of them fill one register.
+        __m256i type = _mm256_loadu_si256((const __m256i*)(enemies->type + i));
+        __m256 isSmall = _mm256_castsi256_ps(_mm256_cmpeq_epi32(type, vSmall));
+        __m256 isBoss = _mm256_castsi256_ps(_mm256_cmpeq_epi32(type, vBoss));
+        __m256 moving = _mm256_or_ps(isSmall, isBoss);
+        if (_mm256_movemask_ps(moving) == 0) {
+            continue;
+        }
+
+        __m256 p0 = _mm256_loadu_ps(enemies->movementPattern + i);
+        __m256 rate = _mm256_blendv_ps(vRateBoss, vRateSmall, isSmall);
+        __m256 p1 = _mm256_add_ps(p0, _mm256_mul_ps(rate, vDt));
+        __m256 sweep = sinAvx(_mm256_blendv_ps(p1, _mm256_add_ps(p1, vHalfPi), isSmall));
+        __m256 cosP0 = sinAvx(_mm256_add_ps(p0, vHalfPi));
+
+        __m256 y = _mm256_loadu_ps(enemies->y + i);
+        __m256 h = _mm256_loadu_ps(enemies->height + i);
+        __m256 ySmall = _mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(WOBBLE_AMPLITUDE), _mm256_sub_ps(cosP0, sweep)));
+        __m256 yBoss = _mm256_add_ps(vCenter, _mm256_mul_ps(sweep, vSweep));
+        yBoss = _mm256_min_ps(_mm256_max_ps(yBoss, _mm256_mul_ps(h, vHalf)), _mm256_sub_ps(vFieldH, h));
+        y = _mm256_blendv_ps(y, ySmall, isSmall);
+        y = _mm256_blendv_ps(y, yBoss, isBoss);
+        _mm256_storeu_ps(enemies->y + i, y);
+
+        __m256 wrapped = _mm256_sub_ps(p1, _mm256_and_ps(_mm256_cmp_ps(p1, vTwoPi, _CMP_GE_OQ), vTwoPi));
+        _mm256_storeu_ps(enemies->movementPattern + i, _mm256_blendv_ps(p0, wrapped, moving));
+    }
+
+    for (; i < end; i++) {
+        moveEnemyScalar(enemies, i, deltaTime, fieldHeight);
+    }
+}
+
+#elif defined(__SSE2__)
+
+static __m128 sinSse(__m128 x) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(MOTION_INV_TWO_PI))));
+    __m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(MOTION_TWO_PI_HI))),
+                          _mm_mul_ps(k, _mm_set1_ps(MOTION_TWO_PI_LO)));
+    __m128 a = _mm_andnot_ps(signMask, r);
+    __m128 m = _mm_min_ps(a, _mm_sub_ps(_mm_set1_ps(MOTION_PI), a));
+    __m128 m2 = _mm_mul_ps(m, m);
+    __m128 p = _mm_set1_ps(SIN_C11);
+    p = _mm_add_ps(_mm_mul_ps(p, m2), _mm_set1_ps(SIN_C9));
+    p = _mm_add_ps(_mm_mul_ps(p, m2), _mm_set1_ps(SIN_C7));
+    p = _mm_add_ps(_mm_mul_ps(p, m2), _mm_set1_ps(SIN_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, m2), _mm_set1_ps(SIN_C3));
+    __m128 s = _mm_add_ps(m, _mm_mul_ps(_mm_mul_ps(m, m2), p));
+    return _mm_xor_ps(s, _mm_and_ps(r, signMask));
+}
+
+static __m128 selectSse(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+    return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+void motionSinBatch(const float* x, float* out, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, sinSse(_mm_loadu_ps(x + i)));
+    }
+    for (; i < n; i++) {
+        out[i] = motionSin(x[i]);
+    }
+}
+
+void updateEnemyMotion(EnemyPool* enemies, int begin, int end, float deltaTime, float fieldHeight) {
+    const __m128 vDt = _mm_set1_ps(deltaTime);
+    const __m128 vHalfPi = _mm_set1_ps(MOTION_HALF_PI);
+    const __m128 vTwoPi = _mm_set1_ps(MOTION_TWO_PI);
+    const __m128 vCenter = _mm_set1_ps((float)(int)(fieldHeight / 2));
+    const __m128 vSweep = _mm_set1_ps((float)(int)(fieldHeight / 3));
+    const __m128 vFieldH = _mm_set1_ps(fieldHeight);
+    const __m128 vHalf = _mm_set1_ps(0.5f);
+    const __m128 vRateSmall = _mm_set1_ps(WOBBLE_RATE);
+    const __m128 vRateBoss = _mm_set1_ps(BOSS_SWEEP_RATE);
+    const __m128i vSmall = _mm_set1_epi32(ENEMY_SMALL);
+    const __m128i vBoss = _mm_set1_epi32(ENEMY_BOSS);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(enemies->x + i);
+        x = _mm_sub_ps(x, _mm_mul_ps(_mm_loadu_ps(enemies->speed + i), vDt));
+        _mm_storeu_ps(enemies->x + i, x);
+
+        // EnemyType is an int-sized enum, so four of them fill one register.
+        __m128i type = _mm_loadu_si128((const __m128i*)(enemies->type + i));
+        __m128 isSmall = _mm_castsi128_ps(_mm_cmpeq_epi32(type, vSmall));
+        __m128 isBoss = _mm_castsi128_ps(_mm_cmpeq_epi32(type, vBoss));
+        __m128 moving = _mm_or_ps(isSmall, isBoss);
+        if (_mm_movemask_ps(moving) == 0) {
+            continue;
+        }
+
+        __m128 p0 = _mm_loadu_ps(enemies->movementPattern + i);
+        __m128 rate = selectSse(isSmall, vRateSmall, vRateBoss);
+        __m128 p1 = _mm_add_ps(p0, _mm_mul_ps(rate, vDt));
+        __m128 sweep = sinSse(selectSse(isSmall, _mm_add_ps(p1, vHalfPi), p1));
+        __m128 cosP0 = sinSse(_mm_add_ps(p0, vHalfPi));
+
+        __m128 y = _mm_loadu_ps(enemies->y + i);
+        __m128 h = _mm_loadu_ps(enemies->height + i);
+        __m128 ySmall = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(WOBBLE_AMPLITUDE), _mm_sub_ps(cosP0, sweep)));
+        __m128 yBoss = _mm_add_ps(vCenter, _mm_mul_ps(sweep, vSweep));
+        yBoss = _mm_min_ps(_mm_max_ps(yBoss, _mm_mul_ps(h, vHalf)), _mm_sub_ps(vFieldH, h));
+        y = selectSse(isSmall, ySmall, y);
+        y = selectSse(isBoss, yBoss, y);
+        _mm_storeu_ps(enemies->y + i, y);
+
+        __m128 wrapped = _mm_sub_ps(p1, _mm_and_ps(_mm_cmpge_ps(p1, vTwoPi), vTwoPi));
+        _mm_storeu_ps(enemies->movementPattern + i, selectSse(moving, wrapped, p0));
+    }
+
+    for (; i < end; i++) {
+        moveEnemyScalar(enemies, i, deltaTime, fieldHeight);
+    }
+}
+
+#else
+
+void motionSinBatch(const float* x, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = motionSin(x[i]);
+    }
+}
+
+void updateEnemyMotion(EnemyPool* enemies, int begin, int end, float deltaTime, float fieldHeight) {
+    for (int i = begin; i < end; i++) {
+        moveEnemyScalar(enemies, i, deltaTime, fieldHeight);
+    }
+}
+
+#endif
@@ -0,0 +1,234 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "fixedstep.h"
+#include "pipeline.h"
+#include "trace.h"
+
+// Triple buffer: the simulation thread owns backSlot, the render thread owns
+// frontSlot, and the third slot is parked in sharedSlot. Publishing swaps the
+// back slot into sharedSlot with SLOT_FRESH set; the render thread swaps its
+// front slot back in only while SLOT_FRESH is set, so neither side ever
+// waits on the other or sees a half-written snapshot.
+#define SLOT_MASK 3u
+#define SLOT_FRESH 4u
+
+static RenderSnapshot slots[3];
+static unsigned sharedSlot;
+static unsigned backSlot;
+static unsigned frontSlot;
+
+static pthread_t simThread;
+static bool started;
+static bool stopRequested;
+static bool finished;
+
+static GameState* simState;
+static double tickSeconds;
+static int maxSubsteps;
+static double droppedSeconds;
+static unsigned ticks;
+static unsigned published;
+static double maxTickSeconds;
+
+static PipelineTickFn tickHook;
+static void* tickHookCtx;
+
+static double* tickLog;
+static int tickLogCapacity;
+static int tickLogCount;
+static bool tickLogging;
+
+static int pendingDirection;
+static int pendingFires;
+static bool pendingQuit;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void sleepSeconds(double seconds) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+static void publishSnapshot(double tickTime) {
+    TRACE_BEGIN("instance pack");
+    snapshotCapture(&slots[backSlot], simState, ticks);
+    slots[backSlot].tickTime = tickTime;
+    TRACE_END();
+    unsigned previous = __atomic_exchange_n(&sharedSlot, backSlot | SLOT_FRESH, __ATOMIC_ACQ_REL);
+    backSlot = previous & SLOT_MASK;
+    published++;
+}
+
+static void applyInput(void) {
+    simState->player.direction = (Direction)__atomic_load_n(&pendingDirection, __ATOMIC_ACQUIRE);
+
+    int fires = __atomic_exchange_n(&pendingFires, 0, __ATOMIC_ACQ_REL);
+    for (; fires > 0; fires--) {
+        fireBullet(simState);
+    }
+
+    if (__atomic_exchange_n(&pendingQuit, false, __ATOMIC_ACQ_REL)) {
+        simState->gameOver = true;
+    }
+}
+
+// Same fixed-tick loop as the serial main loop, except that it sleeps until
+// the next tick is due instead of rendering.
+static void* simMain(void* arg) {
+    (void)arg;
+    TRACE_THREAD_NAME("simulation");
+
+    FixedStep step;
+    fixedStepInit(&step, tickSeconds, maxSubsteps, nowSeconds());
+
+    while (!__atomic_load_n(&stopRequested, __ATOMIC_ACQUIRE) && !simState->gameOver) {
+        int due = fixedStepAdvance(&step, nowSeconds());
+
+        applyInput();
+
+        if (due == 0) {
+            sleepSeconds(tickSeconds - step.accumulator);
+            continue;
+        }
+
+        for (int t = 0; t < due; t++) {
+            double tickStart = nowSeconds();
+            updateGame(simState, (float)tickSeconds);
+            double tickTime = nowSeconds() - tickStart;
+            if (tickTime > maxTickSeconds) maxTickSeconds = tickTime;
+            if (__atomic_load_n(&tickLogging, __ATOMIC_RELAXED) && tickLogCount < tickLogCapacity) {
+                tickLog[tickLogCount++] = tickTime;
+            }
+
+            if (tickHook) {
+                tickHook(tickHookCtx, simState);
+            }
+
+            ticks++;
+        }
+
+        // The last tick was due accumulator seconds before lastTime.
+        publishSnapshot(step.lastTime - step.accumulator);
+        droppedSeconds = step.droppedSeconds;
+    }
+
+    publishSnapshot(step.lastTime - step.accumulator);
+    __atomic_store_n(&finished, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+bool pipelineStart(GameState* gameState, double tick, int substeps) {
+    pipelineStop();
+
+    simState = gameState;
+    tickSeconds = tick;
+    maxSubsteps = substeps;
+    droppedSeconds = 0.0;
+    ticks = 0;
+    published = 0;
+    maxTickSeconds = 0.0;
+    tickLogCount = 0;
+    stopRequested = false;
+    finished = false;
+
+    pendingDirection = (int)gameState->player.direction;
+    pendingFires = 0;
+    pendingQuit = false;
+
+    frontSlot = 0;
+    backSlot = 1;
+    sharedSlot = 2;
+    snapshotCapture(&slots[frontSlot], gameState, 0);
+    slots[frontSlot].tickTime = nowSeconds();
+
+    if (pthread_create(&simThread, NULL, simMain, NULL) != 0) {
+        printf("Failed to start simulation thread\n");
+        return false;
+    }
+    started = true;
+    return true;
+}
+
+void pipelineStop(void) {
+    if (!started) {
+        return;
+    }
+
+    __atomic_store_n(&stopRequested, true, __ATOMIC_RELEASE);
+    pthread_join(simThread, NULL);
+    started = false;
+}
+
+bool pipelineRunning(void) {
+    return started && !__atomic_load_n(&finished, __ATOMIC_ACQUIRE);
+}
+
+const RenderSnapshot* pipelineLatest(void) {
+    if (__atomic_load_n(&sharedSlot, __ATOMIC_ACQUIRE) & SLOT_FRESH) {
+        unsigned previous = __atomic_exchange_n(&sharedSlot, frontSlot, __ATOMIC_ACQ_REL);
+        frontSlot = previous & SLOT_MASK;
+    }
+    return &slots[frontSlot];
+}
+
+unsigned pipelineTicks(void) {
+    return ticks;
+}
+
+unsigned pipelinePublished(void) {
+    return published;
+}
+
+double pipelineMaxTickSeconds(void) {
+    return maxTickSeconds;
+}
+
+double pipelineDroppedSeconds(void) {
+    return droppedSeconds;
+}
+
+float pipelineAlpha(const RenderSnapshot* snapshot) {
+    float alpha = (float)((nowSeconds() - snapshot->tickTime) / tickSeconds);
+    if (alpha < 0.0f) return 0.0f;
+    return alpha < 1.0f ? alpha : 1.0f;
+}
+
+void pipelineOnTick(PipelineTickFn fn, void* ctx) {
+    tickHook = fn;
+    tickHookCtx = ctx;
+}
+
+void pipelineLogTicks(double* samples, int capacity) {
+    tickLog = samples;
+    tickLogCapacity = samples ? capacity : 0;
+}
+
+void pipelineSetTickLogging(bool enabled) {
+    __atomic_store_n(&tickLogging, enabled, __ATOMIC_RELAXED);
+}
+
+int pipelineLoggedTicks(void) {
+    return tickLogCount;
+}
+
+void pipelineSetDirection(Direction direction) {
+    __atomic_store_n(&pendingDirection, (int)direction, __ATOMIC_RELEASE);
+}
+
+void pipelineQueueFire(void) {
+    __atomic_add_fetch(&pendingFires, 1, __ATOMIC_ACQ_REL);
+}
+
+void pipelineQueueQuit(void) {
+    __atomic_store_n(&pendingQuit, true, __ATOMIC_RELEASE);
+}
@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,6 +6,7 @@
 
 #include "renderer.h"
 #include "resources.h"
+#include "trace.h"
 
 static const char* vertexShaderSource = 
 "#version 330 core\n"
@@ -40,12 +42,14 @@ static const char* bulletVertexShaderSource =
 "layout (location = 2) in vec2 iPos;\n"
 "layout (location = 3) in vec2 iSize;\n"
 "layout (location = 4) in vec4 iColor;\n"
+"layout (location = 5) in vec2 iPrevPos;\n"
 "out vec2 TexCoord;\n"
 "out vec4 Color;\n"
 "uniform mat4 projection;\n"
+"uniform float alpha;\n"
 "void main()\n"
 "{\n"
-"    vec2 worldPos = iPos + aPos * iSize;\n"
+"    vec2 worldPos = mix(iPrevPos, iPos, alpha) + aPos * iSize;\n"
 "    gl_Position = projection * vec4(worldPos, 0.0, 1.0);\n"
 "    TexCoord = aTexCoord;\n"
 "    Color = iColor;\n"
@@ -70,19 +74,16 @@ typedef struct {
     GLuint bulletShaderProgram;
     GLuint VAO, VBO, EBO;
     GLuint bulletInstanceVBO;
+    // Instances bulletInstanceVBO has room for.
+    int instanceCapacity;
     GLuint textures[SPRITE_COUNT];
     GLint modelLoc;
     GLint projectionLoc;
     GLint colorLoc;
     GLint bulletProjectionLoc;
+    GLint bulletAlphaLoc;
 } Renderer;
 
-typedef struct {
-    float x, y;
-    float w, h;
-    float r, g, b, a;
-} SpriteInstance;
-
 static Renderer renderer;
 
 static GLuint compileShader(GLenum type, const char* source) {
@@ -145,6 +146,7 @@ bool initRenderer() {
     renderer.projectionLoc = glGetUniformLocation(renderer.shaderProgram, "projection");
     renderer.colorLoc = glGetUniformLocation(renderer.shaderProgram, "color");
     renderer.bulletProjectionLoc = glGetUniformLocation(renderer.bulletShaderProgram, "projection");
+    renderer.bulletAlphaLoc = glGetUniformLocation(renderer.bulletShaderProgram, "alpha");
     
     float vertices[] = {
          0.5f,  0.5f,         1.0f, 0.0f,   
@@ -177,16 +179,21 @@ bool initRenderer() {
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 8 * MAX_BULLETS, NULL, GL_STREAM_DRAW);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(0));
+    // Sized on the first renderSnapshot, to match the snapshot.
+    glBufferData(GL_ARRAY_BUFFER, 0, NULL, GL_STREAM_DRAW);
+    renderer.instanceCapacity = 0;
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, x));
     glEnableVertexAttribArray(2);
     glVertexAttribDivisor(2, 1);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(sizeof(float) * 2));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, w));
     glEnableVertexAttribArray(3);
     glVertexAttribDivisor(3, 1);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(sizeof(float) * 4));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, r));
     glEnableVertexAttribArray(4);
     glVertexAttribDivisor(4, 1);
+    glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, prevX));
+    glEnableVertexAttribArray(5);
+    glVertexAttribDivisor(5, 1);
     
     glBindBuffer(GL_ARRAY_BUFFER, 0); 
     glBindVertexArray(0); 
@@ -240,14 +247,33 @@ static void drawQuad(float x, float y, float width, float height, float r, float
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
 
-void renderGame(GameState* gameState) {
+// Texture used for each snapshot batch.
+static const SpriteType batchSprites[SNAPSHOT_BATCH_COUNT] = {
+    SPRITE_BULLET,
+    SPRITE_ENEMY_BULLET,
+    SPRITE_ENEMY_SMALL,
+    SPRITE_ENEMY_MEDIUM,
+    SPRITE_ENEMY_LARGE,
+    SPRITE_ENEMY_BOSS,
+    SPRITE_POWERUP_HEALTH,
+    SPRITE_POWERUP_RAPID_FIRE,
+    SPRITE_POWERUP_DOUBLE_BULLET,
+    SPRITE_EXPLOSION
+};
+
+static float lerp(float from, float to, float t) {
+    return from + (to - from) * t;
+}
+
+void renderSnapshot(const RenderSnapshot* snapshot, float alpha) {
+    TRACE_BEGIN("renderSnapshot");
     glClearColor(0.0f, 0.0f, 0.05f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     glUseProgram(renderer.shaderProgram);
     glBindVertexArray(renderer.VAO);
     
-    float farScrollPos = fmodf(gameState->level.backgroundOffset, 256.0f);
+    float farScrollPos = fmodf(lerp(snapshot->prevBackgroundOffset, snapshot->backgroundOffset, alpha), 256.0f);
     
     glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_BACKGROUND]);
     drawQuad(256.0f - farScrollPos, 160, 256, 320, 0.4f, 0.4f, 0.5f, 0.3f);
@@ -255,14 +281,14 @@ void renderGame(GameState* gameState) {
     drawQuad(768.0f - farScrollPos, 160, 256, 320, 0.4f, 0.4f, 0.5f, 0.3f);
     drawQuad(0.0f   - farScrollPos, 160, 256, 320, 0.4f, 0.4f, 0.5f, 0.3f);
 
-    float midScrollPos = fmodf(gameState->level.midgroundOffset, 256.0f);
+    float midScrollPos = fmodf(lerp(snapshot->prevMidgroundOffset, snapshot->midgroundOffset, alpha), 256.0f);
     
     drawQuad(256.0f - midScrollPos, 160, 256, 320, 0.5f, 0.5f, 0.6f, 0.5f);
     drawQuad(512.0f - midScrollPos, 160, 256, 320, 0.5f, 0.5f, 0.6f, 0.5f);
     drawQuad(768.0f - midScrollPos, 160, 256, 320, 0.5f, 0.5f, 0.6f, 0.5f);
     drawQuad(0.0f   - midScrollPos, 160, 256, 320, 0.5f, 0.5f, 0.6f, 0.5f);
     
-    float nearScrollPos = fmodf(gameState->level.foregroundOffset, 256.0f);
+    float nearScrollPos = fmodf(lerp(snapshot->prevForegroundOffset, snapshot->foregroundOffset, alpha), 256.0f);
     
     drawQuad(256.0f - nearScrollPos, 160, 256, 320, 0.7f, 0.7f, 0.8f, 0.7f);
     drawQuad(512.0f - nearScrollPos, 160, 256, 320, 0.7f, 0.7f, 0.8f, 0.7f);
@@ -270,232 +296,67 @@ void renderGame(GameState* gameState) {
     drawQuad(0.0f   - nearScrollPos, 160, 256, 320, 0.7f, 0.7f, 0.8f, 0.7f);
     
     glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_PLAYER]);
-    drawQuad(gameState->player.x, gameState->player.y, 
-             gameState->player.width, gameState->player.height, 1.0f, 1.0f, 1.0f, 1.0f);
-    
-    static SpriteInstance bulletInstances[MAX_BULLETS];
-    int bulletCount = 0;
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (gameState->bullets[i].active) {
-            SpriteInstance s;
-            s.x = gameState->bullets[i].x;
-            s.y = gameState->bullets[i].y;
-            s.w = gameState->bullets[i].width;
-            s.h = gameState->bullets[i].height;
-            s.r = 1.0f; s.g = 1.0f; s.b = 0.5f; s.a = 1.0f;
-            bulletInstances[bulletCount++] = s;
-        }
-    }
-    if (bulletCount > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_BULLET]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(bulletCount * (int)sizeof(SpriteInstance)), bulletInstances);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, bulletCount);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    
-    static SpriteInstance enemyBulletInstances[MAX_ENEMY_BULLETS];
-    int enemyBulletCount = 0;
-    for (int i = 0; i < MAX_ENEMY_BULLETS; i++) {
-        if (gameState->enemyBullets[i].active) {
-            SpriteInstance s;
-            s.x = gameState->enemyBullets[i].x;
-            s.y = gameState->enemyBullets[i].y;
-            s.w = gameState->enemyBullets[i].width;
-            s.h = gameState->enemyBullets[i].height;
-            s.r = 1.0f; s.g = 0.0f; s.b = 0.0f; s.a = 1.0f;
-            enemyBulletInstances[enemyBulletCount++] = s;
-        }
-    }
-    if (enemyBulletCount > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_ENEMY_BULLET]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(enemyBulletCount * (int)sizeof(SpriteInstance)), enemyBulletInstances);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, enemyBulletCount);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    
-    static SpriteInstance enemiesSmall[MAX_ENEMIES];
-    static SpriteInstance enemiesMedium[MAX_ENEMIES];
-    static SpriteInstance enemiesLarge[MAX_ENEMIES];
-    static SpriteInstance enemiesBoss[MAX_ENEMIES];
-    int countSmall = 0, countMedium = 0, countLarge = 0, countBoss = 0;
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (!gameState->enemies[i].active) continue;
-        SpriteInstance s;
-        s.x = gameState->enemies[i].x;
-        s.y = gameState->enemies[i].y;
-        s.w = gameState->enemies[i].width;
-        s.h = gameState->enemies[i].height;
-        s.r = 1.0f; s.g = 1.0f; s.b = 1.0f; s.a = 1.0f;
-        switch (gameState->enemies[i].type) {
-            case ENEMY_SMALL:
-                enemiesSmall[countSmall++] = s;
-                break;
-            case ENEMY_MEDIUM:
-                enemiesMedium[countMedium++] = s;
-                break;
-            case ENEMY_LARGE:
-                enemiesLarge[countLarge++] = s;
-                break;
-            case ENEMY_BOSS:
-                enemiesBoss[countBoss++] = s;
-                break;
-            default:
-                enemiesSmall[countSmall++] = s;
-                break;
-        }
-    }
-    if (countSmall > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_ENEMY_SMALL]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countSmall * (int)sizeof(SpriteInstance)), enemiesSmall);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countSmall);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    if (countMedium > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_ENEMY_MEDIUM]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countMedium * (int)sizeof(SpriteInstance)), enemiesMedium);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countMedium);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    if (countLarge > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_ENEMY_LARGE]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countLarge * (int)sizeof(SpriteInstance)), enemiesLarge);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countLarge);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    if (countBoss > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_ENEMY_BOSS]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countBoss * (int)sizeof(SpriteInstance)), enemiesBoss);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countBoss);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    
-    static SpriteInstance powerupsHealth[MAX_POWERUPS];
-    static SpriteInstance powerupsRapid[MAX_POWERUPS];
-    static SpriteInstance powerupsDouble[MAX_POWERUPS];
-    int countHealth = 0, countRapid = 0, countDouble = 0;
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (!gameState->powerups[i].active) continue;
-        SpriteInstance s;
-        s.x = gameState->powerups[i].x;
-        s.y = gameState->powerups[i].y;
-        s.w = gameState->powerups[i].width;
-        s.h = gameState->powerups[i].height;
-        switch (gameState->powerups[i].type) {
-            case POWERUP_HEALTH:
-                s.r = 0.0f; s.g = 1.0f; s.b = 0.0f; s.a = 1.0f;
-                powerupsHealth[countHealth++] = s;
-                break;
-            case POWERUP_RAPID_FIRE:
-                s.r = 1.0f; s.g = 1.0f; s.b = 0.0f; s.a = 1.0f;
-                powerupsRapid[countRapid++] = s;
-                break;
-            case POWERUP_DOUBLE_BULLET:
-                s.r = 0.0f; s.g = 0.5f; s.b = 1.0f; s.a = 1.0f;
-                powerupsDouble[countDouble++] = s;
-                break;
-            default:
-                s.r = 0.0f; s.g = 1.0f; s.b = 0.0f; s.a = 1.0f;
-                powerupsHealth[countHealth++] = s;
-                break;
-        }
-    }
-    if (countHealth > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_POWERUP_HEALTH]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countHealth * (int)sizeof(SpriteInstance)), powerupsHealth);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countHealth);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    if (countRapid > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_POWERUP_RAPID_FIRE]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countRapid * (int)sizeof(SpriteInstance)), powerupsRapid);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countRapid);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
-    }
-    if (countDouble > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_POWERUP_DOUBLE_BULLET]);
+    drawQuad(lerp(snapshot->prevPlayerX, snapshot->playerX, alpha),
+             lerp(snapshot->prevPlayerY, snapshot->playerY, alpha),
+             snapshot->playerWidth, snapshot->playerHeight, 1.0f, 1.0f, 1.0f, 1.0f);
+
+    // Any batch fits in the snapshot's capacity, so the buffer is only
+    // respecified when the pools were reallocated larger.
+    if (snapshot->instanceCapacity > renderer.instanceCapacity) {
         glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(countDouble * (int)sizeof(SpriteInstance)), powerupsDouble);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, countDouble);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(sizeof(SpriteInstance) * (size_t)snapshot->instanceCapacity),
+                     NULL, GL_STREAM_DRAW);
+        renderer.instanceCapacity = snapshot->instanceCapacity;
     }
 
-    static SpriteInstance explosionInstances[MAX_EXPLOSIONS];
-    int explosionCount = 0;
-    for (int i = 0; i < MAX_EXPLOSIONS; i++) {
-        if (!gameState->explosions[i].active) continue;
-        SpriteInstance s;
-        s.x = gameState->explosions[i].x;
-        s.y = gameState->explosions[i].y;
-        s.w = gameState->explosions[i].width;
-        s.h = gameState->explosions[i].height;
-        float alpha = gameState->explosions[i].currentLife / gameState->explosions[i].lifespan;
-        s.r = 1.0f; s.g = 0.7f; s.b = 0.0f; s.a = alpha;
-        explosionInstances[explosionCount++] = s;
-    }
-    if (explosionCount > 0) {
-        glUseProgram(renderer.bulletShaderProgram);
-        glBindVertexArray(renderer.VAO);
-        glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_EXPLOSION]);
-        glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(explosionCount * (int)sizeof(SpriteInstance)), explosionInstances);
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, explosionCount);
-        glUseProgram(renderer.shaderProgram);
-        glBindVertexArray(renderer.VAO);
+    for (int b = 0; b < SNAPSHOT_BATCH_COUNT; b++) {
+        int start = snapshot->batchStart[b];
+        int count = snapshot->batchStart[b + 1] - start;
+        if (count > 0) {
+            glUseProgram(renderer.bulletShaderProgram);
+            glUniform1f(renderer.bulletAlphaLoc, alpha);
+            glBindVertexArray(renderer.VAO);
+            glBindTexture(GL_TEXTURE_2D, renderer.textures[batchSprites[b]]);
+            glBindBuffer(GL_ARRAY_BUFFER, renderer.bulletInstanceVBO);
+            TRACE_BEGIN("glBufferSubData");
+            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sizeof(SpriteInstance) * (size_t)count),
+                            snapshot->instances + start);
+            TRACE_END();
+            TRACE_BEGIN("draw batch");
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, count);
+            TRACE_END();
+            glUseProgram(renderer.shaderProgram);
+            glBindVertexArray(renderer.VAO);
+        }
     }
 
-    if (!gameState->benchmarkMode) {
+    if (!snapshot->benchmarkMode) {
         glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_HUD_LIFE]);
-        for (int i = 0; i < gameState->player.lives; i++) {
+        for (int i = 0; i < snapshot->lives; i++) {
             drawQuad(20 + (i * 20), 20, 16, 16, 1.0f, 1.0f, 1.0f, 1.0f);
         }
 
-        if (gameState->player.isRapidFire) {
+        if (snapshot->isRapidFire) {
             glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_POWERUP_RAPID_FIRE]);
             drawQuad(430, 20, 16, 16, 1.0f, 1.0f, 0.0f, 1.0f);
         }
 
-        if (gameState->player.isDoubleBullet) {
+        if (snapshot->isDoubleBullet) {
             glBindTexture(GL_TEXTURE_2D, renderer.textures[SPRITE_POWERUP_DOUBLE_BULLET]);
             drawQuad(450, 20, 16, 16, 0.0f, 0.5f, 1.0f, 1.0f);
         }
     }
 
     glBindVertexArray(0);
+    TRACE_END();
+}
+
+void renderGame(GameState* gameState, float alpha) {
+    static RenderSnapshot snapshot;
+    TRACE_BEGIN("instance pack");
+    snapshotCapture(&snapshot, gameState, 0);
+    TRACE_END();
+    renderSnapshot(&snapshot, alpha);
 }
 
 void renderGameOver(GameState* gameState) {
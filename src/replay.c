@@ -0,0 +1,203 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+#define REPLAY_MAGIC "SIRP"
+#define REPLAY_VERSION 1u
+#define REPLAY_HEADER_SIZE 24
+
+#define INPUT_DIRECTION_MASK 0x0Fu
+#define INPUT_FIRE_SHIFT 4
+#define INPUT_FIRE_MASK 0x70u
+#define INPUT_QUIT 0x80u
+
+void applyTickInput(GameState* gameState, const TickInput* input) {
+    gameState->player.direction = input->direction;
+    for (int f = 0; f < input->fires; f++) {
+        fireBullet(gameState);
+    }
+    if (input->quit) {
+        gameState->gameOver = true;
+    }
+}
+
+static unsigned char encodeInput(const TickInput* input) {
+    int fires = input->fires < REPLAY_MAX_FIRES ? input->fires : REPLAY_MAX_FIRES;
+    return (unsigned char)(((unsigned)input->direction & INPUT_DIRECTION_MASK) |
+                           ((unsigned)fires << INPUT_FIRE_SHIFT) |
+                           (input->quit ? INPUT_QUIT : 0u));
+}
+
+static void decodeInput(unsigned char byte, TickInput* input) {
+    input->direction = (Direction)(byte & INPUT_DIRECTION_MASK);
+    input->fires = (byte & INPUT_FIRE_MASK) >> INPUT_FIRE_SHIFT;
+    input->quit = (byte & INPUT_QUIT) != 0;
+}
+
+static void putU32(unsigned char* out, uint32_t v) {
+    for (int b = 0; b < 4; b++) {
+        out[b] = (unsigned char)(v >> (8 * b));
+    }
+}
+
+static uint32_t getU32(const unsigned char* in) {
+    uint32_t v = 0;
+    for (int b = 0; b < 4; b++) {
+        v |= (uint32_t)in[b] << (8 * b);
+    }
+    return v;
+}
+
+static void writeHeader(FILE* f, uint32_t seed, uint32_t ticks, uint64_t finalHash) {
+    unsigned char header[REPLAY_HEADER_SIZE];
+    memcpy(header, REPLAY_MAGIC, 4);
+    putU32(header + 4, REPLAY_VERSION);
+    putU32(header + 8, seed);
+    putU32(header + 12, ticks);
+    putU32(header + 16, (uint32_t)finalHash);
+    putU32(header + 20, (uint32_t)(finalHash >> 32));
+    fwrite(header, 1, sizeof(header), f);
+}
+
+bool replayRecordOpen(ReplayRecorder* recorder, const char* path, uint32_t seed) {
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->file = fopen(path, "wb");
+    if (!recorder->file) {
+        fprintf(stderr, "Failed to open replay file %s\n", path);
+        return false;
+    }
+    recorder->seed = seed;
+
+    // Rewritten with the real tick count and hash on close.
+    writeHeader(recorder->file, seed, 0, 0);
+    return true;
+}
+
+static void flushRun(ReplayRecorder* recorder) {
+    if (recorder->runLength == 0) {
+        return;
+    }
+    unsigned char run[2] = { recorder->runInput, recorder->runLength };
+    fwrite(run, 1, sizeof(run), recorder->file);
+    recorder->runLength = 0;
+}
+
+void replayRecordTick(ReplayRecorder* recorder, const TickInput* input) {
+    if (!recorder->file) {
+        return;
+    }
+
+    unsigned char byte = encodeInput(input);
+    if (recorder->runLength > 0 && (byte != recorder->runInput || recorder->runLength == 255)) {
+        flushRun(recorder);
+    }
+    recorder->runInput = byte;
+    recorder->runLength++;
+    recorder->ticks++;
+}
+
+bool replayRecordClose(ReplayRecorder* recorder, uint64_t finalHash) {
+    if (!recorder->file) {
+        return true;
+    }
+
+    flushRun(recorder);
+    fseek(recorder->file, 0, SEEK_SET);
+    writeHeader(recorder->file, recorder->seed, recorder->ticks, finalHash);
+    bool ok = ferror(recorder->file) == 0;
+    if (fclose(recorder->file) != 0) {
+        ok = false;
+    }
+    recorder->file = NULL;
+
+    if (!ok) {
+        fprintf(stderr, "Failed to write replay file\n");
+    }
+    return ok;
+}
+
+bool replayLoad(Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open replay file %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (size < REPLAY_HEADER_SIZE) {
+        fprintf(stderr, "Replay file %s is too short\n", path);
+        fclose(f);
+        return false;
+    }
+
+    replay->data = malloc((size_t)size);
+    if (!replay->data) {
+        fprintf(stderr, "Failed to allocate %ld bytes for replay\n", size);
+        exit(1);
+    }
+    replay->size = fread(replay->data, 1, (size_t)size, f);
+    fclose(f);
+
+    const unsigned char* header = replay->data;
+    if (replay->size < REPLAY_HEADER_SIZE || memcmp(header, REPLAY_MAGIC, 4) != 0 ||
+        getU32(header + 4) != REPLAY_VERSION) {
+        fprintf(stderr, "%s is not a version %u replay file\n", path, REPLAY_VERSION);
+        replayFree(replay);
+        return false;
+    }
+
+    replay->seed = getU32(header + 8);
+    replay->ticks = getU32(header + 12);
+    replay->finalHash = (uint64_t)getU32(header + 16) | ((uint64_t)getU32(header + 20) << 32);
+    replay->pos = REPLAY_HEADER_SIZE;
+    return true;
+}
+
+bool replayNext(Replay* replay, TickInput* input) {
+    if (replay->played == replay->ticks) {
+        return false;
+    }
+
+    if (replay->runLeft == 0) {
+        if (replay->pos + 2 > replay->size) {
+            return false;
+        }
+        replay->runInput = replay->data[replay->pos];
+        replay->runLeft = replay->data[replay->pos + 1];
+        replay->pos += 2;
+        if (replay->runLeft == 0) {
+            return false;
+        }
+    }
+
+    decodeInput(replay->runInput, input);
+    replay->runLeft--;
+    replay->played++;
+    return true;
+}
+
+int replayCheck(const Replay* replay, uint64_t finalHash, FILE* out) {
+    if (replay->played < replay->ticks) {
+        fprintf(out, "Replay stopped at tick %u of %u; final state not checked\n", replay->played, replay->ticks);
+        return 1;
+    }
+    if (finalHash != replay->finalHash) {
+        fprintf(out, "Replay diverged: final state hash %016" PRIx64 ", recorded %016" PRIx64 "\n",
+               finalHash, replay->finalHash);
+        return 2;
+    }
+    fprintf(out, "Replay matches the recording: %u ticks, state hash %016" PRIx64 "\n", replay->ticks, finalHash);
+    return 0;
+}
+
+void replayFree(Replay* replay) {
+    free(replay->data);
+    replay->data = NULL;
+    replay->size = 0;
+}
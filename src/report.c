@@ -0,0 +1,447 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+
+#include "jobs.h"
+#include "report.h"
+
+#ifndef SPACE_OPT_FLAGS
+#define SPACE_OPT_FLAGS "unknown"
+#endif
+
+#define MAX_METRICS 16
+
+static const double histogramEdges[REPORT_HISTOGRAM_BUCKETS - 1] = {
+    0.5, 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 50.0, 100.0
+};
+
+typedef struct {
+    char name[32];
+    double value;
+    bool higherIsBetter;
+} Metric;
+
+// Emits the same sections and fields as nested JSON objects or as flat
+// "section.key,value" CSV rows, so both formats always carry the same data.
+typedef struct {
+    FILE* f;
+    ReportFormat format;
+    const char* section;
+    bool firstSection;
+    bool firstField;
+} ReportWriter;
+
+bool reportFormatFromName(const char* name, ReportFormat* out) {
+    if (strcmp(name, "json") == 0) {
+        *out = REPORT_JSON;
+    } else if (strcmp(name, "csv") == 0) {
+        *out = REPORT_CSV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static int cmpAscDouble(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    if (da < db) return -1;
+    if (da > db) return 1;
+    return 0;
+}
+
+double latencyPercentile(const double* sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+void latencyStatsCompute(LatencyStats* stats, double* samples, int count) {
+    memset(stats, 0, sizeof(*stats));
+    if (count <= 0) {
+        return;
+    }
+
+    qsort(samples, (size_t)count, sizeof(double), cmpAscDouble);
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        double ms = samples[i] * 1000.0;
+        sum += ms;
+
+        int bucket = 0;
+        while (bucket < REPORT_HISTOGRAM_BUCKETS - 1 && ms > histogramEdges[bucket]) {
+            bucket++;
+        }
+        stats->histogram[bucket]++;
+    }
+
+    stats->count = count;
+    stats->mean = sum / count;
+    stats->min = samples[0] * 1000.0;
+    stats->p50 = latencyPercentile(samples, count, 50.0) * 1000.0;
+    stats->p90 = latencyPercentile(samples, count, 90.0) * 1000.0;
+    stats->p99 = latencyPercentile(samples, count, 99.0) * 1000.0;
+    stats->p999 = latencyPercentile(samples, count, 99.9) * 1000.0;
+    stats->max = samples[count - 1] * 1000.0;
+}
+
+static const char* simdLevel(void) {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__AVX__)
+    return "avx";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+static const char* compilerVersion(void) {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+// First "model name" line of /proc/cpuinfo; "unknown" where there is none.
+static void cpuModel(char* out, size_t size) {
+    snprintf(out, size, "unknown");
+
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (!f) {
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "model name", 10) != 0) {
+            continue;
+        }
+        char* value = strchr(line, ':');
+        if (value) {
+            value++;
+            while (*value == ' ' || *value == '\t') value++;
+            value[strcspn(value, "\n")] = '\0';
+            snprintf(out, size, "%s", value);
+        }
+        break;
+    }
+    fclose(f);
+}
+
+static void writeJsonString(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static void writeCsvString(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"') fputc('"', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void beginSection(ReportWriter* w, const char* name) {
+    w->section = name;
+    w->firstField = true;
+    if (w->format == REPORT_JSON) {
+        fprintf(w->f, "%s\n  \"%s\": {", w->firstSection ? "" : ",", name);
+    }
+    w->firstSection = false;
+}
+
+static void endSection(ReportWriter* w) {
+    if (w->format == REPORT_JSON) {
+        fprintf(w->f, "\n  }");
+    }
+}
+
+static void beginField(ReportWriter* w, const char* key) {
+    if (w->format == REPORT_JSON) {
+        fprintf(w->f, "%s\n    \"%s\": ", w->firstField ? "" : ",", key);
+    } else {
+        fprintf(w->f, "%s.%s,", w->section, key);
+    }
+    w->firstField = false;
+}
+
+static void endField(ReportWriter* w) {
+    if (w->format == REPORT_CSV) {
+        fputc('\n', w->f);
+    }
+}
+
+static void fieldString(ReportWriter* w, const char* key, const char* value) {
+    beginField(w, key);
+    if (w->format == REPORT_JSON) {
+        writeJsonString(w->f, value);
+    } else {
+        writeCsvString(w->f, value);
+    }
+    endField(w);
+}
+
+static void fieldDouble(ReportWriter* w, const char* key, double value) {
+    beginField(w, key);
+    fprintf(w->f, "%.6f", value);
+    endField(w);
+}
+
+static void fieldInt(ReportWriter* w, const char* key, long value) {
+    beginField(w, key);
+    fprintf(w->f, "%ld", value);
+    endField(w);
+}
+
+static void fieldBool(ReportWriter* w, const char* key, bool value) {
+    beginField(w, key);
+    fprintf(w->f, "%s", value ? "true" : "false");
+    endField(w);
+}
+
+static void writeLatency(ReportWriter* w, const char* name, const char* histogramName,
+                         const LatencyStats* stats) {
+    if (stats->count == 0) {
+        return;
+    }
+
+    beginSection(w, name);
+    fieldInt(w, "count", stats->count);
+    fieldDouble(w, "mean", stats->mean);
+    fieldDouble(w, "min", stats->min);
+    fieldDouble(w, "p50", stats->p50);
+    fieldDouble(w, "p90", stats->p90);
+    fieldDouble(w, "p99", stats->p99);
+    fieldDouble(w, "p99_9", stats->p999);
+    fieldDouble(w, "max", stats->max);
+    endSection(w);
+
+    beginSection(w, histogramName);
+    for (int b = 0; b < REPORT_HISTOGRAM_BUCKETS; b++) {
+        char key[32];
+        if (b < REPORT_HISTOGRAM_BUCKETS - 1) {
+            snprintf(key, sizeof(key), "le_%g", histogramEdges[b]);
+        } else {
+            snprintf(key, sizeof(key), "gt_%g", histogramEdges[b - 1]);
+        }
+        fieldInt(w, key, stats->histogram[b]);
+    }
+    endSection(w);
+}
+
+static void addMetric(Metric* metrics, int* count, const char* name, double value, bool higherIsBetter) {
+    if (value <= 0.0 || *count == MAX_METRICS) {
+        return;
+    }
+    Metric* m = &metrics[(*count)++];
+    snprintf(m->name, sizeof(m->name), "%s", name);
+    m->value = value;
+    m->higherIsBetter = higherIsBetter;
+}
+
+// The headline numbers a baseline is compared on. Metrics the run did not
+// produce (zero) are left out.
+static int collectMetrics(const BenchReport* report, Metric* metrics) {
+    int count = 0;
+    addMetric(metrics, &count, "avg_fps", report->avgFps, true);
+    addMetric(metrics, &count, "one_percent_low_fps", report->onePercentLowFps, true);
+    addMetric(metrics, &count, "ticks_per_second", report->ticksPerSecond, true);
+    if (report->frames.count > 0) {
+        addMetric(metrics, &count, "frame_ms_p50", report->frames.p50, false);
+        addMetric(metrics, &count, "frame_ms_p90", report->frames.p90, false);
+        addMetric(metrics, &count, "frame_ms_p99", report->frames.p99, false);
+        addMetric(metrics, &count, "frame_ms_p99_9", report->frames.p999, false);
+    }
+    if (report->ticks.count > 0) {
+        addMetric(metrics, &count, "tick_ms_p50", report->ticks.p50, false);
+        addMetric(metrics, &count, "tick_ms_p90", report->ticks.p90, false);
+        addMetric(metrics, &count, "tick_ms_p99", report->ticks.p99, false);
+        addMetric(metrics, &count, "tick_ms_p99_9", report->ticks.p999, false);
+    }
+    return count;
+}
+
+bool reportWrite(const BenchReport* report, ReportFormat format, const char* path) {
+    FILE* f = path ? fopen(path, "w") : stdout;
+    if (!f) {
+        fprintf(stderr, "Failed to open report file %s\n", path);
+        return false;
+    }
+
+    ReportWriter w = { f, format, NULL, true, true };
+    if (format == REPORT_JSON) {
+        fprintf(f, "{");
+    } else {
+        fprintf(f, "key,value\n");
+    }
+
+    beginSection(&w, "config");
+    fieldString(&w, "tool", report->tool);
+    fieldInt(&w, "density", report->density);
+    fieldInt(&w, "threads", report->threads);
+    fieldInt(&w, "seed", (long)report->seed);
+    fieldString(&w, "broadphase", broadPhaseName(report->broadPhase));
+    fieldBool(&w, "pipelined", report->pipelined);
+    endSection(&w);
+
+    beginSection(&w, "capacity");
+    fieldInt(&w, "bullets", report->capacities.bullets);
+    fieldInt(&w, "enemies", report->capacities.enemies);
+    fieldInt(&w, "enemy_bullets", report->capacities.enemyBullets);
+    fieldInt(&w, "powerups", report->capacities.powerups);
+    fieldInt(&w, "explosions", report->capacities.explosions);
+    endSection(&w);
+
+    beginSection(&w, "build");
+    fieldString(&w, "compiler", compilerVersion());
+    fieldString(&w, "opt", SPACE_OPT_FLAGS);
+    fieldString(&w, "simd", simdLevel());
+#ifdef SPACE_TRACE
+    fieldBool(&w, "trace", true);
+#else
+    fieldBool(&w, "trace", false);
+#endif
+    endSection(&w);
+
+    struct utsname host;
+    char cpu[128];
+    cpuModel(cpu, sizeof(cpu));
+    beginSection(&w, "host");
+    if (uname(&host) == 0) {
+        fieldString(&w, "os", host.sysname);
+        fieldString(&w, "release", host.release);
+        fieldString(&w, "machine", host.machine);
+    }
+    fieldString(&w, "cpu", cpu);
+    fieldInt(&w, "hardware_threads", jobsHardwareThreads());
+    endSection(&w);
+
+    Metric metrics[MAX_METRICS];
+    int metricCount = collectMetrics(report, metrics);
+    beginSection(&w, "metrics");
+    fieldDouble(&w, "measured_seconds", report->measuredSeconds);
+    for (int m = 0; m < metricCount; m++) {
+        fieldDouble(&w, metrics[m].name, metrics[m].value);
+    }
+    endSection(&w);
+
+    writeLatency(&w, "frame_ms", "frame_histogram_ms", &report->frames);
+    writeLatency(&w, "tick_ms", "tick_histogram_ms", &report->ticks);
+
+    beginSection(&w, "entities");
+    fieldInt(&w, "bullets", report->bullets);
+    fieldInt(&w, "enemies", report->enemies);
+    fieldInt(&w, "enemy_bullets", report->enemyBullets);
+    fieldInt(&w, "powerups", report->powerups);
+    fieldInt(&w, "explosions", report->explosions);
+    fieldInt(&w, "score", report->score);
+    endSection(&w);
+
+    if (format == REPORT_JSON) {
+        fprintf(f, "\n}\n");
+    }
+
+    if (path) {
+        fclose(f);
+    } else {
+        fflush(f);
+    }
+    return true;
+}
+
+static char* readFile(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* text = (size >= 0) ? malloc((size_t)size + 1) : NULL;
+    if (!text) {
+        fclose(f);
+        return NULL;
+    }
+    size_t got = fread(text, 1, (size_t)size, f);
+    text[got] = '\0';
+    fclose(f);
+    return text;
+}
+
+// Looks the metric up in the baseline's "metrics" object. This only has to
+// read files reportWrite produced, so it matches on the quoted key rather
+// than parsing JSON in general.
+static bool baselineMetric(const char* metricsBlock, const char* name, double* out) {
+    char key[48];
+    snprintf(key, sizeof(key), "\"%.40s\":", name);
+
+    const char* end = strchr(metricsBlock, '}');
+    const char* found = strstr(metricsBlock, key);
+    if (!found || (end && found > end)) {
+        return false;
+    }
+
+    char* parsedEnd;
+    *out = strtod(found + strlen(key), &parsedEnd);
+    return parsedEnd != found + strlen(key);
+}
+
+int reportCompareBaseline(const BenchReport* report, const char* path, double tolerancePercent, FILE* out) {
+    char* text = readFile(path);
+    if (!text) {
+        fprintf(out, "Failed to read baseline %s\n", path);
+        return -1;
+    }
+
+    const char* metricsBlock = strstr(text, "\"metrics\"");
+    if (!metricsBlock) {
+        fprintf(out, "Baseline %s has no metrics\n", path);
+        free(text);
+        return -1;
+    }
+
+    Metric metrics[MAX_METRICS];
+    int metricCount = collectMetrics(report, metrics);
+    int regressions = 0;
+
+    fprintf(out, "\nBaseline comparison (%s, tolerance %.1f%%)\n", path, tolerancePercent);
+    fprintf(out, "%-22s %12s %12s %9s\n", "metric", "baseline", "current", "change");
+    for (int m = 0; m < metricCount; m++) {
+        double base;
+        if (!baselineMetric(metricsBlock, metrics[m].name, &base) || base <= 0.0) {
+            continue;
+        }
+
+        double change = (metrics[m].value - base) / base * 100.0;
+        double worse = metrics[m].higherIsBetter ? -change : change;
+        bool regressed = worse > tolerancePercent;
+        if (regressed) regressions++;
+
+        fprintf(out, "%-22s %12.3f %12.3f %+8.1f%%%s\n", metrics[m].name, base, metrics[m].value,
+                change, regressed ? "  REGRESSION" : "");
+    }
+    fprintf(out, "%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+
+    free(text);
+    return regressions;
+}
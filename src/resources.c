@@ -306,11 +306,13 @@ static GLuint createExplosionTexture() {
 
     static GLuint createBackgroundTexture() {
         unsigned char pixels[256 * 256 * 4] = {0};
-        
+
+        // Own stream, so loading resources does not shift the game's sequence.
+        RngStream stars = rng_stream(rng_current_seed(), RNG_STREAM_BACKGROUND);
         for (int i = 0; i < 200; i++) {
-            int x = (int)(rng_u32() % 256u);
-            int y = (int)(rng_u32() % 256u);
-            int brightness = (int)(rng_u32() % 155u) + 100;
+            int x = (int)(rng_stream_next(&stars) % 256u);
+            int y = (int)(rng_stream_next(&stars) % 256u);
+            int brightness = (int)(rng_stream_next(&stars) % 155u) + 100;
             
             int index = (y * 256 + x) * 4;
             pixels[index + 0] = brightness;
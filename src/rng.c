@@ -1,43 +1,305 @@
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
-static uint32_t rng_state[4] = { 0u, 0u, 0u, 0u };
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-static uint32_t rotl32(uint32_t x, int k) {
-    return (uint32_t)((x << k) | (x >> (32 - k)));
+#include "rng.h"
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+// Values of the global sequence generated per refill.
+#define RNG_BATCH 256
+
+static RngStream global;
+static uint32_t globalBatch[RNG_BATCH];
+static int globalNext = RNG_BATCH;
+
+static uint32_t mulhilo(uint32_t a, uint32_t b, uint32_t* hi) {
+    uint64_t product = (uint64_t)a * b;
+    *hi = (uint32_t)(product >> 32);
+    return (uint32_t)product;
 }
 
-static uint32_t splitmix32(uint32_t* seed) {
-    uint32_t z = (*seed += 0x9E3779B9u);
-    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
-    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
-    z ^= z >> 16;
-    return z;
+void rng_block(uint32_t seed, uint32_t stream, uint64_t block, uint32_t out[4]) {
+    uint32_t c0 = (uint32_t)block;
+    uint32_t c1 = (uint32_t)(block >> 32);
+    uint32_t c2 = 0u;
+    uint32_t c3 = 0u;
+    uint32_t k0 = seed;
+    uint32_t k1 = stream;
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint32_t hi0, hi1;
+        uint32_t lo0 = mulhilo(PHILOX_M0, c0, &hi0);
+        uint32_t lo1 = mulhilo(PHILOX_M1, c2, &hi1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
 }
 
-void rng_seed(uint32_t seed) {
-    if (seed == 0u) {
-        seed = 0xA3C59AC3u;
+#if defined(__AVX2__)
+
+#define PHILOX_LANES 8
+
+static inline void mulhilo8(__m256i a, __m256i m, __m256i* lo, __m256i* hi) {
+    const __m256i lowMask = _mm256_set1_epi64x(0xFFFFFFFFll);
+    __m256i even = _mm256_mul_epu32(a, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    *lo = _mm256_or_si256(_mm256_and_si256(even, lowMask), _mm256_slli_epi64(odd, 32));
+    *hi = _mm256_or_si256(_mm256_srli_epi64(even, 32), _mm256_andnot_si256(lowMask, odd));
+}
+
+// Eight consecutive blocks, one per lane, written out in block order.
+static void philoxLanes(uint32_t seed, uint32_t stream, uint64_t block, uint32_t* out) {
+    __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32((int)(uint32_t)block),
+                                  _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i c1 = _mm256_set1_epi32((int)(uint32_t)(block >> 32));
+    __m256i c2 = _mm256_setzero_si256();
+    __m256i c3 = _mm256_setzero_si256();
+    const __m256i m0 = _mm256_set1_epi32((int)PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi32((int)PHILOX_M1);
+    uint32_t k0 = seed;
+    uint32_t k1 = stream;
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        __m256i lo0, hi0, lo1, hi1;
+        mulhilo8(c0, m0, &lo0, &hi0);
+        mulhilo8(c2, m1, &lo1, &hi1);
+        c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+        c1 = lo1;
+        c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    // Transpose within each 128-bit half, then pair the halves up.
+    __m256i t0 = _mm256_unpacklo_epi32(c0, c1);
+    __m256i t1 = _mm256_unpacklo_epi32(c2, c3);
+    __m256i t2 = _mm256_unpackhi_epi32(c0, c1);
+    __m256i t3 = _mm256_unpackhi_epi32(c2, c3);
+    __m256i b04 = _mm256_unpacklo_epi64(t0, t1);
+    __m256i b15 = _mm256_unpackhi_epi64(t0, t1);
+    __m256i b26 = _mm256_unpacklo_epi64(t2, t3);
+    __m256i b37 = _mm256_unpackhi_epi64(t2, t3);
+    _mm256_storeu_si256((__m256i*)(out + 0), _mm256_permute2x128_si256(b04, b15, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 8), _mm256_permute2x128_si256(b26, b37, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 16), _mm256_permute2x128_si256(b04, b15, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 24), _mm256_permute2x128_si256(b26, b37, 0x31));
+}
+
+#elif defined(__SSE2__)
+
+#define PHILOX_LANES 4
+
+static inline void mulhilo4(__m128i a, __m128i m, __m128i* lo, __m128i* hi) {
+    const __m128i lowMask = _mm_set_epi32(0, -1, 0, -1);
+    __m128i even = _mm_mul_epu32(a, m);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+    *lo = _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+    *hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lowMask, odd));
+}
+
+// Four consecutive blocks, one per lane, written out in block order.
+static void philoxLanes(uint32_t seed, uint32_t stream, uint64_t block, uint32_t* out) {
+    __m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)(uint32_t)block), _mm_setr_epi32(0, 1, 2, 3));
+    __m128i c1 = _mm_set1_epi32((int)(uint32_t)(block >> 32));
+    __m128i c2 = _mm_setzero_si128();
+    __m128i c3 = _mm_setzero_si128();
+    const __m128i m0 = _mm_set1_epi32((int)PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32((int)PHILOX_M1);
+    uint32_t k0 = seed;
+    uint32_t k1 = stream;
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        __m128i lo0, hi0, lo1, hi1;
+        mulhilo4(c0, m0, &lo0, &hi0);
+        mulhilo4(c2, m1, &lo1, &hi1);
+        c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32((int)k0));
+        c1 = lo1;
+        c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32((int)k1));
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
     }
-    uint32_t s = seed;
-    rng_state[0] = splitmix32(&s);
-    rng_state[1] = splitmix32(&s);
-    rng_state[2] = splitmix32(&s);
-    rng_state[3] = splitmix32(&s);
+
+    __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+    __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+    __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+    __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+    _mm_storeu_si128((__m128i*)(out + 0), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi64(t2, t3));
+}
+
+#endif
+
+// count consecutive blocks starting at block, 4 * count values.
+static void philoxBlocks(uint32_t seed, uint32_t stream, uint64_t block, int count, uint32_t* out) {
+    int b = 0;
+#if defined(PHILOX_LANES)
+    // The lanes only carry into the high counter word when the low word
+    // wraps inside a group; leave that (practically unreachable) case to the
+    // scalar loop.
+    for (; b + PHILOX_LANES <= count; b += PHILOX_LANES) {
+        uint64_t first = block + (uint64_t)b;
+        if ((uint32_t)first > UINT32_MAX - (PHILOX_LANES - 1)) {
+            break;
+        }
+        philoxLanes(seed, stream, first, out + 4 * b);
+    }
+#endif
+    for (; b < count; b++) {
+        rng_block(seed, stream, block + (uint64_t)b, out + 4 * b);
+    }
+}
+
+uint32_t rng_at(uint32_t seed, uint32_t stream, uint64_t counter) {
+    uint32_t block[4];
+    rng_block(seed, stream, counter >> 2, block);
+    return block[counter & 3u];
+}
+
+RngStream rng_stream(uint32_t seed, uint32_t stream) {
+    RngStream s = { seed, stream, 0u, { 0u, 0u, 0u, 0u } };
+    return s;
+}
+
+uint32_t rng_stream_next(RngStream* s) {
+    unsigned lane = (unsigned)(s->counter & 3u);
+    if (lane == 0u) {
+        rng_block(s->seed, s->stream, s->counter >> 2, s->buffer);
+    }
+    s->counter++;
+    return s->buffer[lane];
+}
+
+void rng_stream_fill(RngStream* s, uint32_t* out, int n) {
+    int k = 0;
+    while (k < n && (s->counter & 3u) != 0u) {
+        out[k++] = rng_stream_next(s);
+    }
+
+    int blocks = (n - k) / 4;
+    philoxBlocks(s->seed, s->stream, s->counter >> 2, blocks, out + k);
+    s->counter += 4u * (uint64_t)blocks;
+    k += 4 * blocks;
+
+    while (k < n) {
+        out[k++] = rng_stream_next(s);
+    }
+}
+
+// Lemire's nearly divisionless bounded draw: the high half of x * range is
+// uniform on [0, range) unless the low half falls below 2^32 mod range, in
+// which case x has to be redrawn. The modulo is only computed on that path.
+static bool lemireAccept(uint32_t x, uint32_t range, uint32_t* result) {
+    uint64_t m = (uint64_t)x * range;
+    uint32_t low = (uint32_t)m;
+    if (low < range) {
+        uint32_t threshold = (0u - range) % range;
+        if (low < threshold) {
+            return false;
+        }
+    }
+    *result = (uint32_t)(m >> 32);
+    return true;
+}
+
+uint32_t rng_stream_bounded(RngStream* s, uint32_t x, uint32_t range) {
+    uint32_t result;
+    while (!lemireAccept(x, range, &result)) {
+        x = rng_stream_next(s);
+    }
+    return result;
+}
+
+void rng_seed(uint32_t seed) {
+    global = rng_stream(seed, RNG_STREAM_GLOBAL);
+    globalNext = RNG_BATCH;
 }
 
 uint32_t rng_u32(void) {
-    uint32_t result = rotl32(rng_state[0] + rng_state[3], 7) + rng_state[0];
+    if (globalNext == RNG_BATCH) {
+        rng_stream_fill(&global, globalBatch, RNG_BATCH);
+        globalNext = 0;
+    }
+    return globalBatch[globalNext++];
+}
 
-    uint32_t t = rng_state[1] << 9;
+uint32_t rng_current_seed(void) {
+    return global.seed;
+}
 
-    rng_state[2] ^= rng_state[0];
-    rng_state[3] ^= rng_state[1];
-    rng_state[1] ^= rng_state[2];
-    rng_state[0] ^= rng_state[3];
-    rng_state[2] ^= t;
+uint64_t rng_position(void) {
+    return global.counter - (uint64_t)(RNG_BATCH - globalNext);
+}
 
-    rng_state[3] = rotl32(rng_state[3], 11);
+void rng_restore(uint32_t seed, uint64_t position) {
+    global = rng_stream(seed, RNG_STREAM_GLOBAL);
+    global.counter = position;
+    if ((position & 3u) != 0u) {
+        rng_block(seed, RNG_STREAM_GLOBAL, position >> 2, global.buffer);
+    }
+    globalNext = RNG_BATCH;
+}
 
+uint32_t rng_range(uint32_t range) {
+    uint32_t result;
+    while (!lemireAccept(rng_u32(), range, &result)) {
+    }
     return result;
 }
 
+void rng_fill_u32(uint32_t* out, int n) {
+    int buffered = RNG_BATCH - globalNext;
+    if (buffered > n) {
+        buffered = n;
+    }
+    memcpy(out, globalBatch + globalNext, sizeof(uint32_t) * (size_t)buffered);
+    globalNext += buffered;
+
+    // The batch is empty now (or n is covered), so the rest comes straight
+    // from the stream.
+    rng_stream_fill(&global, out + buffered, n - buffered);
+}
+
+void rng_fill_range(uint32_t* out, int n, uint32_t range) {
+    rng_fill_u32(out, n);
+    for (int i = 0; i < n; i++) {
+        uint32_t x = out[i];
+        while (!lemireAccept(x, range, &out[i])) {
+            x = rng_u32();
+        }
+    }
+}
+
+void rng_fill_float(float* out, int n) {
+    uint32_t raw[RNG_BATCH];
+    for (int done = 0; done < n; done += RNG_BATCH) {
+        int count = n - done < RNG_BATCH ? n - done : RNG_BATCH;
+        rng_fill_u32(raw, count);
+        for (int i = 0; i < count; i++) {
+            out[done + i] = (float)(raw[i] >> 8) * (1.0f / 16777216.0f);
+        }
+    }
+}
@@ -0,0 +1,273 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rng.h"
+#include "savestate.h"
+
+#define SAVE_MAGIC "SISV"
+#define SAVE_VERSION 2u
+#define SAVE_BYTE_ORDER 0x01020304u
+
+// Every pool column, in file order. Adding a column means bumping
+// SAVE_VERSION.
+#define STATE_COLUMNS(X)                                                        \
+    X(bullets, x) X(bullets, y) X(bullets, width) X(bullets, height)             \
+    X(bullets, speed) X(bullets, active)                                         \
+    X(enemies, x) X(enemies, y) X(enemies, width) X(enemies, height)             \
+    X(enemies, speed) X(enemies, health) X(enemies, type) X(enemies, active)     \
+    X(enemies, bulletCooldown) X(enemies, movementPattern) X(enemies, score)     \
+    X(enemyBullets, x) X(enemyBullets, y) X(enemyBullets, width)                 \
+    X(enemyBullets, height) X(enemyBullets, speed) X(enemyBullets, active)       \
+    X(powerups, x) X(powerups, y) X(powerups, width) X(powerups, height)         \
+    X(powerups, type) X(powerups, active) X(powerups, speed)                     \
+    X(explosions, x) X(explosions, y) X(explosions, width)                       \
+    X(explosions, height) X(explosions, lifespan) X(explosions, currentLife)     \
+    X(explosions, active) X(explosions, persistent) X(explosions, spawnSequence)
+
+// All fields are 4 bytes wide, so the struct has no padding and is read
+// straight out of the mapping.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    // sizeof(bool), sizeof(enum) and the file size; a mismatch means the
+    // file came from a build with a different layout.
+    uint32_t boolSize;
+    uint32_t enumSize;
+    uint32_t fileSize;
+
+    uint32_t rngSeed;
+    uint32_t rngPositionLow;
+    uint32_t rngPositionHigh;
+
+    float playerX;
+    float playerY;
+    float playerWidth;
+    float playerHeight;
+    uint32_t playerDirection;
+    int32_t playerLives;
+    uint32_t playerRapidFire;
+    uint32_t playerDoubleBullet;
+    float playerPowerupTimer;
+    int32_t playerScore;
+    float playerBulletCooldown;
+
+    int32_t levelNumber;
+    float scrollSpeed;
+    float enemySpawnRate;
+    float backgroundOffset;
+    float midgroundOffset;
+    float foregroundOffset;
+    uint32_t bossSpawned;
+    uint32_t bossDefeated;
+
+    uint32_t gameOver;
+    uint32_t benchmarkMode;
+    float benchmarkSpawnBand;
+    float enemySpawnTimer;
+    float powerupSpawnTimer;
+
+    int32_t bulletCount;
+    int32_t enemyCount;
+    int32_t enemyBulletCount;
+    int32_t powerupCount;
+    int32_t explosionCount;
+} SaveHeader;
+
+#define COLUMN_BYTES(state, pool, column) \
+    (sizeof((state)->pool.column[0]) * (size_t)(state)->pool.count)
+
+static size_t columnBytes(const GameState* gameState) {
+    size_t total = 0;
+#define ADD_COLUMN(pool, column) total += COLUMN_BYTES(gameState, pool, column);
+    STATE_COLUMNS(ADD_COLUMN)
+#undef ADD_COLUMN
+    return total;
+}
+
+bool saveState(const GameState* gameState, const char* path) {
+    SaveHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SAVE_MAGIC, 4);
+    h.version = SAVE_VERSION;
+    h.byteOrder = SAVE_BYTE_ORDER;
+    h.boolSize = (uint32_t)sizeof(bool);
+    h.enumSize = (uint32_t)sizeof(EnemyType);
+    h.fileSize = (uint32_t)(sizeof(h) + columnBytes(gameState));
+
+    uint64_t position = rng_position();
+    h.rngSeed = rng_current_seed();
+    h.rngPositionLow = (uint32_t)position;
+    h.rngPositionHigh = (uint32_t)(position >> 32);
+
+    const Player* p = &gameState->player;
+    h.playerX = p->x;
+    h.playerY = p->y;
+    h.playerWidth = p->width;
+    h.playerHeight = p->height;
+    h.playerDirection = (uint32_t)p->direction;
+    h.playerLives = p->lives;
+    h.playerRapidFire = p->isRapidFire;
+    h.playerDoubleBullet = p->isDoubleBullet;
+    h.playerPowerupTimer = p->powerupTimer;
+    h.playerScore = p->score;
+    h.playerBulletCooldown = p->bulletCooldown;
+
+    const Level* l = &gameState->level;
+    h.levelNumber = l->number;
+    h.scrollSpeed = l->scrollSpeed;
+    h.enemySpawnRate = l->enemySpawnRate;
+    h.backgroundOffset = l->backgroundOffset;
+    h.midgroundOffset = l->midgroundOffset;
+    h.foregroundOffset = l->foregroundOffset;
+    h.bossSpawned = l->bossSpawned;
+    h.bossDefeated = l->bossDefeated;
+
+    h.gameOver = gameState->gameOver;
+    h.benchmarkMode = gameState->benchmarkMode;
+    h.benchmarkSpawnBand = gameState->benchmarkSpawnBand;
+    h.enemySpawnTimer = gameState->enemySpawnTimer;
+    h.powerupSpawnTimer = gameState->powerupSpawnTimer;
+
+    h.bulletCount = gameState->bullets.count;
+    h.enemyCount = gameState->enemies.count;
+    h.enemyBulletCount = gameState->enemyBullets.count;
+    h.powerupCount = gameState->powerups.count;
+    h.explosionCount = gameState->explosions.count;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to open savestate %s\n", path);
+        return false;
+    }
+
+    fwrite(&h, sizeof(h), 1, f);
+#define WRITE_COLUMN(pool, column) \
+    fwrite(gameState->pool.column, 1, COLUMN_BYTES(gameState, pool, column), f);
+    STATE_COLUMNS(WRITE_COLUMN)
+#undef WRITE_COLUMN
+
+    bool ok = ferror(f) == 0;
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Failed to write savestate %s\n", path);
+    }
+    return ok;
+}
+
+static bool countFits(int32_t count, int capacity) {
+    return count >= 0 && count <= capacity;
+}
+
+bool loadState(GameState* gameState, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open savestate %s\n", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SaveHeader)) {
+        fprintf(stderr, "Savestate %s is too short\n", path);
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    const unsigned char* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map savestate %s\n", path);
+        return false;
+    }
+
+    SaveHeader h;
+    memcpy(&h, map, sizeof(h));
+
+    bool valid = memcmp(h.magic, SAVE_MAGIC, 4) == 0 && h.version == SAVE_VERSION &&
+                 h.byteOrder == SAVE_BYTE_ORDER && h.boolSize == sizeof(bool) &&
+                 h.enumSize == sizeof(EnemyType) && h.fileSize == size &&
+                 countFits(h.bulletCount, gameState->bullets.capacity) &&
+                 countFits(h.enemyCount, gameState->enemies.capacity) &&
+                 countFits(h.enemyBulletCount, gameState->enemyBullets.capacity) &&
+                 countFits(h.powerupCount, gameState->powerups.capacity) &&
+                 countFits(h.explosionCount, gameState->explosions.capacity);
+
+    // The counts decide how many bytes each column takes; check them
+    // against the file size before copying anything.
+    GameState* g = gameState;
+    int oldCounts[5] = { g->bullets.count, g->enemies.count, g->enemyBullets.count,
+                         g->powerups.count, g->explosions.count };
+    if (valid) {
+        g->bullets.count = h.bulletCount;
+        g->enemies.count = h.enemyCount;
+        g->enemyBullets.count = h.enemyBulletCount;
+        g->powerups.count = h.powerupCount;
+        g->explosions.count = h.explosionCount;
+        valid = sizeof(h) + columnBytes(g) == size;
+    }
+    if (!valid) {
+        g->bullets.count = oldCounts[0];
+        g->enemies.count = oldCounts[1];
+        g->enemyBullets.count = oldCounts[2];
+        g->powerups.count = oldCounts[3];
+        g->explosions.count = oldCounts[4];
+        fprintf(stderr, "%s is not a version %u savestate from this build, or does not fit the pool capacities\n",
+                path, SAVE_VERSION);
+        munmap((void*)map, size);
+        return false;
+    }
+
+    const unsigned char* cursor = map + sizeof(h);
+#define READ_COLUMN(pool, column)                                   \
+    memcpy(g->pool.column, cursor, COLUMN_BYTES(g, pool, column));  \
+    cursor += COLUMN_BYTES(g, pool, column);
+    STATE_COLUMNS(READ_COLUMN)
+#undef READ_COLUMN
+    munmap((void*)map, size);
+    // Derived from spawnSequence on the next createExplosion.
+    g->explosions.recycleCount = -1;
+
+    Player* p = &g->player;
+    p->x = h.playerX;
+    p->y = h.playerY;
+    p->width = h.playerWidth;
+    p->height = h.playerHeight;
+    p->direction = (Direction)h.playerDirection;
+    p->lives = h.playerLives;
+    p->isRapidFire = h.playerRapidFire != 0;
+    p->isDoubleBullet = h.playerDoubleBullet != 0;
+    p->powerupTimer = h.playerPowerupTimer;
+    p->score = h.playerScore;
+    p->bulletCooldown = h.playerBulletCooldown;
+
+    Level* l = &g->level;
+    l->number = h.levelNumber;
+    l->scrollSpeed = h.scrollSpeed;
+    l->enemySpawnRate = h.enemySpawnRate;
+    l->backgroundOffset = h.backgroundOffset;
+    l->midgroundOffset = h.midgroundOffset;
+    l->foregroundOffset = h.foregroundOffset;
+    l->bossSpawned = h.bossSpawned != 0;
+    l->bossDefeated = h.bossDefeated != 0;
+
+    g->gameOver = h.gameOver != 0;
+    g->benchmarkMode = h.benchmarkMode != 0;
+    g->benchmarkSpawnBand = h.benchmarkSpawnBand;
+    g->enemySpawnTimer = h.enemySpawnTimer;
+    g->powerupSpawnTimer = h.powerupSpawnTimer;
+
+    rng_restore(h.rngSeed, (uint64_t)h.rngPositionLow | ((uint64_t)h.rngPositionHigh << 32));
+    // Previous positions are render-only and not saved.
+    gameSnapInterpolation(g);
+    return true;
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "snapshot.h"
+
+static SnapshotBatch enemyBatch(EnemyType type) {
+    switch (type) {
+        case ENEMY_MEDIUM: return SNAPSHOT_ENEMIES_MEDIUM;
+        case ENEMY_LARGE:  return SNAPSHOT_ENEMIES_LARGE;
+        case ENEMY_BOSS:   return SNAPSHOT_ENEMIES_BOSS;
+        default:           return SNAPSHOT_ENEMIES_SMALL;
+    }
+}
+
+static SnapshotBatch powerupBatch(PowerupType type) {
+    switch (type) {
+        case POWERUP_RAPID_FIRE:    return SNAPSHOT_POWERUPS_RAPID_FIRE;
+        case POWERUP_DOUBLE_BULLET: return SNAPSHOT_POWERUPS_DOUBLE_BULLET;
+        default:                    return SNAPSHOT_POWERUPS_HEALTH;
+    }
+}
+
+static void putInstance(RenderSnapshot* snapshot, int* cursor, SnapshotBatch batch,
+                        float x, float y, float prevX, float prevY,
+                        float w, float h, float r, float g, float b, float a) {
+    SpriteInstance* s = &snapshot->instances[cursor[batch]++];
+    s->x = x; s->y = y;
+    s->w = w; s->h = h;
+    s->r = r; s->g = g; s->b = b; s->a = a;
+    s->prevX = prevX; s->prevY = prevY;
+}
+
+static void reserveInstances(RenderSnapshot* snapshot, const GameState* gameState) {
+    int needed = gameState->bullets.capacity + gameState->enemyBullets.capacity +
+                 gameState->enemies.capacity + gameState->powerups.capacity +
+                 gameState->explosions.capacity;
+    if (snapshot->instances && needed <= snapshot->instanceCapacity) {
+        return;
+    }
+
+    free(snapshot->instances);
+    snapshot->instances = malloc(sizeof(SpriteInstance) * (size_t)(needed > 0 ? needed : 1));
+    if (!snapshot->instances) {
+        printf("Failed to allocate snapshot (%d instances)\n", needed);
+        exit(EXIT_FAILURE);
+    }
+    snapshot->instanceCapacity = needed;
+}
+
+void snapshotCapture(RenderSnapshot* snapshot, const GameState* gameState, unsigned tick) {
+    reserveInstances(snapshot, gameState);
+    snapshot->tick = tick;
+
+    snapshot->backgroundOffset = gameState->level.backgroundOffset;
+    snapshot->midgroundOffset = gameState->level.midgroundOffset;
+    snapshot->foregroundOffset = gameState->level.foregroundOffset;
+    snapshot->prevBackgroundOffset = gameState->level.prevBackgroundOffset;
+    snapshot->prevMidgroundOffset = gameState->level.prevMidgroundOffset;
+    snapshot->prevForegroundOffset = gameState->level.prevForegroundOffset;
+
+    snapshot->playerX = gameState->player.x;
+    snapshot->playerY = gameState->player.y;
+    snapshot->prevPlayerX = gameState->player.prevX;
+    snapshot->prevPlayerY = gameState->player.prevY;
+    snapshot->playerWidth = gameState->player.width;
+    snapshot->playerHeight = gameState->player.height;
+    snapshot->lives = gameState->player.lives;
+    snapshot->score = gameState->player.score;
+    snapshot->isRapidFire = gameState->player.isRapidFire;
+    snapshot->isDoubleBullet = gameState->player.isDoubleBullet;
+    snapshot->benchmarkMode = gameState->benchmarkMode;
+    snapshot->gameOver = gameState->gameOver;
+
+    // Enemies and powerups split by type, so count first and lay the batches
+    // out back to back.
+    int counts[SNAPSHOT_BATCH_COUNT] = { 0 };
+    counts[SNAPSHOT_BULLETS] = gameState->bullets.count;
+    counts[SNAPSHOT_ENEMY_BULLETS] = gameState->enemyBullets.count;
+    counts[SNAPSHOT_EXPLOSIONS] = gameState->explosions.count;
+    for (int i = 0; i < gameState->enemies.count; i++) {
+        counts[enemyBatch(gameState->enemies.type[i])]++;
+    }
+    for (int i = 0; i < gameState->powerups.count; i++) {
+        counts[powerupBatch(gameState->powerups.type[i])]++;
+    }
+
+    int cursor[SNAPSHOT_BATCH_COUNT];
+    snapshot->batchStart[0] = 0;
+    for (int b = 0; b < SNAPSHOT_BATCH_COUNT; b++) {
+        cursor[b] = snapshot->batchStart[b];
+        snapshot->batchStart[b + 1] = snapshot->batchStart[b] + counts[b];
+    }
+
+    const BulletPool* bullets = &gameState->bullets;
+    for (int i = 0; i < bullets->count; i++) {
+        putInstance(snapshot, cursor, SNAPSHOT_BULLETS, bullets->x[i], bullets->y[i],
+                    bullets->prevX[i], bullets->prevY[i],
+                    bullets->width[i], bullets->height[i], 1.0f, 1.0f, 0.5f, 1.0f);
+    }
+
+    const BulletPool* enemyBullets = &gameState->enemyBullets;
+    for (int i = 0; i < enemyBullets->count; i++) {
+        putInstance(snapshot, cursor, SNAPSHOT_ENEMY_BULLETS, enemyBullets->x[i], enemyBullets->y[i],
+                    enemyBullets->prevX[i], enemyBullets->prevY[i],
+                    enemyBullets->width[i], enemyBullets->height[i], 1.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    const EnemyPool* enemies = &gameState->enemies;
+    for (int i = 0; i < enemies->count; i++) {
+        putInstance(snapshot, cursor, enemyBatch(enemies->type[i]), enemies->x[i], enemies->y[i],
+                    enemies->prevX[i], enemies->prevY[i],
+                    enemies->width[i], enemies->height[i], 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+    const PowerupPool* powerups = &gameState->powerups;
+    for (int i = 0; i < powerups->count; i++) {
+        SnapshotBatch batch = powerupBatch(powerups->type[i]);
+        float r = 0.0f, g = 1.0f, b = 0.0f;
+        if (batch == SNAPSHOT_POWERUPS_RAPID_FIRE) {
+            r = 1.0f; g = 1.0f; b = 0.0f;
+        } else if (batch == SNAPSHOT_POWERUPS_DOUBLE_BULLET) {
+            r = 0.0f; g = 0.5f; b = 1.0f;
+        }
+        putInstance(snapshot, cursor, batch, powerups->x[i], powerups->y[i],
+                    powerups->prevX[i], powerups->prevY[i],
+                    powerups->width[i], powerups->height[i], r, g, b, 1.0f);
+    }
+
+    const ExplosionPool* explosions = &gameState->explosions;
+    for (int i = 0; i < explosions->count; i++) {
+        float alpha = explosions->currentLife[i] / explosions->lifespan[i];
+        // Explosions do not move, so they are their own previous position.
+        putInstance(snapshot, cursor, SNAPSHOT_EXPLOSIONS, explosions->x[i], explosions->y[i],
+                    explosions->x[i], explosions->y[i],
+                    explosions->width[i], explosions->height[i], 1.0f, 0.7f, 0.0f, alpha);
+    }
+}
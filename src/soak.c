@@ -0,0 +1,189 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "soak.h"
+
+// Current resident set size. Falls back to the peak where /proc is missing
+// (macOS, where ru_maxrss is in bytes rather than KiB).
+static long residentKiB(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        long size = 0, resident = 0;
+        int fields = fscanf(f, "%ld %ld", &size, &resident);
+        fclose(f);
+        if (fields == 2) {
+            return resident * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    }
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+bool soakParseMinutes(const char* arg, double* minutes, int* ticks) {
+    char* end = NULL;
+    double value = strtod(arg, &end);
+    double tickCount = value * 60.0 * SOAK_TICK_RATE;
+    // Written so that NaN fails both comparisons.
+    if (end == arg || *end != '\0' || !(tickCount >= 1.0) || !(tickCount <= (double)INT_MAX)) {
+        fprintf(stderr, "Invalid soak length \"%s\": expected minutes covering 1 to %d ticks at %d ticks/s\n",
+                arg, INT_MAX, SOAK_TICK_RATE);
+        return false;
+    }
+    *minutes = value;
+    *ticks = (int)tickCount;
+    return true;
+}
+
+static int liveEntities(const GameState* gameState) {
+    return gameState->bullets.count + gameState->enemies.count + gameState->enemyBullets.count +
+           gameState->powerups.count + gameState->explosions.count;
+}
+
+bool soakOpen(SoakLog* soak, const char* path, FILE* progress) {
+    memset(soak, 0, sizeof(*soak));
+    soak->progress = progress;
+    soak->games = 1;
+    soak->startRssKiB = residentKiB();
+    soak->peakRssKiB = soak->startRssKiB;
+
+    if (path) {
+        soak->file = fopen(path, "w");
+        if (!soak->file) {
+            fprintf(stderr, "Failed to open soak log %s\n", path);
+            return false;
+        }
+        fprintf(soak->file, "seconds,tick,game,level,tick_ms_mean,tick_ms_max,bullets,enemies,"
+                            "enemy_bullets,powerups,explosions,score,scroll_speed,enemy_spawn_rate,"
+                            "background_offset,rss_kib\n");
+    }
+    return true;
+}
+
+static SoakLevelStats* levelStats(SoakLog* soak, int level) {
+    if (level < 1) {
+        level = 1;
+    }
+    if (level > soak->levelCount) {
+        SoakLevelStats* levels = realloc(soak->levels, sizeof(SoakLevelStats) * (size_t)level);
+        if (!levels) {
+            fprintf(stderr, "Failed to allocate soak statistics for %d levels\n", level);
+            exit(EXIT_FAILURE);
+        }
+        memset(levels + soak->levelCount, 0, sizeof(SoakLevelStats) * (size_t)(level - soak->levelCount));
+        soak->levels = levels;
+        soak->levelCount = level;
+    }
+    return &soak->levels[level - 1];
+}
+
+static void sample(SoakLog* soak, const GameState* gameState) {
+    long rss = residentKiB();
+    if (rss > soak->peakRssKiB) {
+        soak->peakRssKiB = rss;
+    }
+
+    double seconds = (double)soak->ticks / SOAK_TICK_RATE;
+    double meanMs = soak->windowTicks > 0 ? soak->windowSeconds * 1000.0 / soak->windowTicks : 0.0;
+    if (soak->file) {
+        fprintf(soak->file, "%.1f,%u,%d,%d,%.4f,%.4f,%d,%d,%d,%d,%d,%d,%.1f,%.3f,%.1f,%ld\n",
+                seconds, soak->ticks, soak->games, gameState->level.number, meanMs,
+                soak->windowMax * 1000.0, gameState->bullets.count, gameState->enemies.count,
+                gameState->enemyBullets.count, gameState->powerups.count, gameState->explosions.count,
+                gameState->player.score, gameState->level.scrollSpeed, gameState->level.enemySpawnRate,
+                gameState->level.backgroundOffset, rss);
+    }
+    if (soak->progress && soak->ticks % (60 * SOAK_TICK_RATE) == 0) {
+        fprintf(soak->progress, "[Soak] %5.1f min, game %d, level %d: tick %.3f ms mean, %.3f ms max, "
+                                "%d entities, %ld KiB resident\n",
+                seconds / 60.0, soak->games, gameState->level.number, meanMs, soak->windowMax * 1000.0,
+                liveEntities(gameState), rss);
+        fflush(soak->progress);
+    }
+
+    soak->windowTicks = 0;
+    soak->windowSeconds = 0.0;
+    soak->windowMax = 0.0;
+}
+
+void soakTick(SoakLog* soak, const GameState* gameState, double tickSeconds) {
+    soak->ticks++;
+    soak->windowTicks++;
+    soak->windowSeconds += tickSeconds;
+    if (tickSeconds > soak->windowMax) {
+        soak->windowMax = tickSeconds;
+    }
+
+    SoakLevelStats* level = levelStats(soak, gameState->level.number);
+    level->ticks++;
+    level->tickSeconds += tickSeconds;
+    if (tickSeconds > level->maxTickSeconds) {
+        level->maxTickSeconds = tickSeconds;
+    }
+    int entities = liveEntities(gameState);
+    if (entities > level->peakEntities) {
+        level->peakEntities = entities;
+    }
+    level->scrollSpeed = gameState->level.scrollSpeed;
+    level->enemySpawnRate = gameState->level.enemySpawnRate;
+
+    if (soak->ticks % SOAK_SAMPLE_TICKS == 0) {
+        sample(soak, gameState);
+    }
+}
+
+void soakGameOver(SoakLog* soak, const GameState* gameState) {
+    if (soak->progress) {
+        fprintf(soak->progress, "[Soak] game %d over at %.1f min on level %d, score %d\n", soak->games,
+                (double)soak->ticks / SOAK_TICK_RATE / 60.0, gameState->level.number, gameState->player.score);
+    }
+    soak->games++;
+}
+
+void soakPrintSummary(const SoakLog* soak, FILE* out) {
+    fprintf(out, "\nSoak results\n");
+    fprintf(out, "Simulated: %.1f min (%u ticks), %d game%s\n", (double)soak->ticks / SOAK_TICK_RATE / 60.0,
+            soak->ticks, soak->games, soak->games == 1 ? "" : "s");
+    fprintf(out, "Resident memory: %ld KiB at start, %ld KiB peak\n", soak->startRssKiB, soak->peakRssKiB);
+    fprintf(out, "%6s %9s %12s %11s %9s %7s %11s\n",
+            "level", "seconds", "tick ms mean", "tick ms max", "entities", "scroll", "spawn rate");
+    for (int i = 0; i < soak->levelCount; i++) {
+        const SoakLevelStats* level = &soak->levels[i];
+        if (level->ticks == 0) {
+            continue;
+        }
+        fprintf(out, "%6d %9.1f %12.4f %11.4f %9d %7.1f %11.3f\n", i + 1,
+                (double)level->ticks / SOAK_TICK_RATE, level->tickSeconds * 1000.0 / level->ticks,
+                level->maxTickSeconds * 1000.0, level->peakEntities, level->scrollSpeed, level->enemySpawnRate);
+    }
+}
+
+bool soakClose(SoakLog* soak) {
+    bool ok = true;
+    if (soak->file) {
+        ok = ferror(soak->file) == 0;
+        if (fclose(soak->file) != 0) {
+            ok = false;
+        }
+        soak->file = NULL;
+        if (!ok) {
+            fprintf(stderr, "Failed to write soak log\n");
+        }
+    }
+    free(soak->levels);
+    soak->levels = NULL;
+    soak->levelCount = 0;
+    return ok;
+}
@@ -0,0 +1,275 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include "rng.h"
+#include "statehash.h"
+
+#define HASH_PRIME_1 0x9E3779B185EBCA87ull
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+
+// Four independent lanes so the multiplies of consecutive words overlap
+// instead of forming one long dependency chain.
+typedef struct {
+    uint64_t lane[4];
+    uint64_t length;
+} Hasher;
+
+static uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t mixWord(uint64_t acc, uint64_t word) {
+    acc += word * HASH_PRIME_2;
+    return rotl64(acc, 31) * HASH_PRIME_1;
+}
+
+static void hasherInit(Hasher* h) {
+    h->lane[0] = HASH_PRIME_1 + HASH_PRIME_2;
+    h->lane[1] = HASH_PRIME_2;
+    h->lane[2] = 0;
+    h->lane[3] = 0 - HASH_PRIME_1;
+    h->length = 0;
+}
+
+static void hashBytes(Hasher* h, const void* data, size_t size) {
+    const unsigned char* p = data;
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        uint64_t w[4];
+        memcpy(w, p + i, sizeof(w));
+        h->lane[0] = mixWord(h->lane[0], w[0]);
+        h->lane[1] = mixWord(h->lane[1], w[1]);
+        h->lane[2] = mixWord(h->lane[2], w[2]);
+        h->lane[3] = mixWord(h->lane[3], w[3]);
+    }
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        h->lane[0] = mixWord(h->lane[0], w);
+    }
+    if (i < size) {
+        uint64_t w = 0;
+        memcpy(&w, p + i, size - i);
+        h->lane[1] = mixWord(h->lane[1], w);
+    }
+    h->length += size;
+}
+
+static void hashValue(Hasher* h, uint64_t value) {
+    h->lane[2] = mixWord(h->lane[2], value);
+    h->length += sizeof(value);
+}
+
+static void hashFloat(Hasher* h, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    hashValue(h, bits);
+}
+
+static uint64_t hasherFinish(const Hasher* h) {
+    uint64_t acc = rotl64(h->lane[0], 1) + rotl64(h->lane[1], 7) +
+                   rotl64(h->lane[2], 12) + rotl64(h->lane[3], 18);
+    acc ^= h->length;
+    acc ^= acc >> 33;
+    acc *= HASH_PRIME_2;
+    acc ^= acc >> 29;
+    acc *= HASH_PRIME_1;
+    acc ^= acc >> 32;
+    return acc;
+}
+
+// Only the live range [0, count) of a column is hashed; the tail holds
+// whatever released entities left behind.
+#define HASH_COLUMN(h, pool, column) hashBytes((h), (pool)->column, sizeof((pool)->column[0]) * (size_t)(pool)->count)
+
+uint64_t stateHash(const GameState* gameState) {
+    Hasher h;
+    hasherInit(&h);
+
+    const Player* p = &gameState->player;
+    hashFloat(&h, p->x);
+    hashFloat(&h, p->y);
+    hashFloat(&h, p->width);
+    hashFloat(&h, p->height);
+    hashValue(&h, (uint64_t)p->direction);
+    hashValue(&h, (uint64_t)(uint32_t)p->lives);
+    hashValue(&h, p->isRapidFire);
+    hashValue(&h, p->isDoubleBullet);
+    hashFloat(&h, p->powerupTimer);
+    hashValue(&h, (uint64_t)(uint32_t)p->score);
+    hashFloat(&h, p->bulletCooldown);
+
+    const BulletPool* pools[2] = { &gameState->bullets, &gameState->enemyBullets };
+    for (int k = 0; k < 2; k++) {
+        const BulletPool* b = pools[k];
+        hashValue(&h, (uint64_t)b->count);
+        HASH_COLUMN(&h, b, x);
+        HASH_COLUMN(&h, b, y);
+        HASH_COLUMN(&h, b, width);
+        HASH_COLUMN(&h, b, height);
+        HASH_COLUMN(&h, b, speed);
+        HASH_COLUMN(&h, b, active);
+    }
+
+    const EnemyPool* e = &gameState->enemies;
+    hashValue(&h, (uint64_t)e->count);
+    HASH_COLUMN(&h, e, x);
+    HASH_COLUMN(&h, e, y);
+    HASH_COLUMN(&h, e, width);
+    HASH_COLUMN(&h, e, height);
+    HASH_COLUMN(&h, e, speed);
+    HASH_COLUMN(&h, e, health);
+    HASH_COLUMN(&h, e, type);
+    HASH_COLUMN(&h, e, active);
+    HASH_COLUMN(&h, e, bulletCooldown);
+    HASH_COLUMN(&h, e, movementPattern);
+    HASH_COLUMN(&h, e, score);
+
+    const PowerupPool* u = &gameState->powerups;
+    hashValue(&h, (uint64_t)u->count);
+    HASH_COLUMN(&h, u, x);
+    HASH_COLUMN(&h, u, y);
+    HASH_COLUMN(&h, u, width);
+    HASH_COLUMN(&h, u, height);
+    HASH_COLUMN(&h, u, type);
+    HASH_COLUMN(&h, u, active);
+    HASH_COLUMN(&h, u, speed);
+
+    const ExplosionPool* x = &gameState->explosions;
+    hashValue(&h, (uint64_t)x->count);
+    HASH_COLUMN(&h, x, x);
+    HASH_COLUMN(&h, x, y);
+    HASH_COLUMN(&h, x, width);
+    HASH_COLUMN(&h, x, height);
+    HASH_COLUMN(&h, x, lifespan);
+    HASH_COLUMN(&h, x, currentLife);
+    HASH_COLUMN(&h, x, active);
+    HASH_COLUMN(&h, x, persistent);
+
+    const Level* l = &gameState->level;
+    hashValue(&h, (uint64_t)(uint32_t)l->number);
+    hashFloat(&h, l->scrollSpeed);
+    hashFloat(&h, l->enemySpawnRate);
+    hashFloat(&h, l->backgroundOffset);
+    hashFloat(&h, l->midgroundOffset);
+    hashFloat(&h, l->foregroundOffset);
+    hashValue(&h, l->bossSpawned);
+    hashValue(&h, l->bossDefeated);
+
+    hashValue(&h, gameState->gameOver);
+    hashFloat(&h, gameState->benchmarkSpawnBand);
+    hashFloat(&h, gameState->enemySpawnTimer);
+    hashFloat(&h, gameState->powerupSpawnTimer);
+
+    hashValue(&h, rng_current_seed());
+    hashValue(&h, rng_position());
+
+    return hasherFinish(&h);
+}
+
+bool stateHashLogOpen(StateHashLog* log, const char* path, bool verify, uint32_t seed, FILE* out) {
+    memset(log, 0, sizeof(*log));
+    log->verify = verify;
+    log->out = out;
+    log->file = fopen(path, verify ? "r" : "w");
+    if (!log->file) {
+        fprintf(stderr, "Failed to open state hash file %s\n", path);
+        return false;
+    }
+
+    if (!verify) {
+        fprintf(log->file, "# space_impact state hashes, seed %u\n", seed);
+    }
+    return true;
+}
+
+// Next "tick hash" line of the reference, skipping comments.
+static bool readReference(FILE* f, unsigned* tick, uint64_t* hash) {
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        return sscanf(line, "%u %" SCNx64, tick, hash) == 2;
+    }
+    return false;
+}
+
+void stateHashLogTick(StateHashLog* log, const GameState* gameState) {
+    if (!log->file) {
+        return;
+    }
+
+    uint64_t hash = stateHash(gameState);
+    unsigned tick = ++log->tick;
+
+    if (!log->verify) {
+        fprintf(log->file, "%u %016" PRIx64 "\n", tick, hash);
+        return;
+    }
+
+    if (log->referenceEnded) {
+        return;
+    }
+
+    unsigned refTick;
+    uint64_t refHash;
+    if (!readReference(log->file, &refTick, &refHash)) {
+        log->referenceEnded = true;
+        return;
+    }
+
+    log->compared++;
+    if (refTick != tick || refHash != hash) {
+        if (log->mismatches == 0) {
+            log->firstMismatch = tick;
+            fprintf(log->out, "State diverged at tick %u: expected %016" PRIx64 ", got %016" PRIx64 "\n",
+                   tick, refHash, hash);
+        }
+        log->mismatches++;
+    }
+}
+
+bool stateHashLogClose(StateHashLog* log) {
+    if (!log->file) {
+        return true;
+    }
+
+    // Reference ticks the run never got to.
+    unsigned extra = 0;
+    if (log->verify && !log->referenceEnded) {
+        unsigned refTick;
+        uint64_t refHash;
+        while (readReference(log->file, &refTick, &refHash)) {
+            extra++;
+        }
+    }
+    fclose(log->file);
+    log->file = NULL;
+
+    if (!log->verify) {
+        return true;
+    }
+
+    // Ticks the reference ended before.
+    unsigned unchecked = log->tick - log->compared;
+    bool ok = log->mismatches == 0 && log->compared > 0 && unchecked == 0 && extra == 0;
+    if (log->compared == 0) {
+        fprintf(log->out, "State hashes: the reference has no ticks to compare; %u ticks unchecked\n",
+                log->tick);
+    } else if (log->mismatches == 0) {
+        fprintf(log->out, "State hashes: %u ticks match the reference\n", log->compared);
+    } else {
+        fprintf(log->out, "State hashes: %u of %u ticks differ, first at tick %u\n",
+                log->mismatches, log->compared, log->firstMismatch);
+    }
+    if (log->compared > 0 && unchecked > 0) {
+        fprintf(log->out, "State hashes: the reference ends at tick %u; %u ticks unchecked\n",
+                log->compared, unchecked);
+    }
+    if (extra > 0) {
+        fprintf(log->out, "State hashes: the reference has %u more ticks than the run\n", extra);
+    }
+    return ok;
+}
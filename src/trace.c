@@ -0,0 +1,202 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "trace.h"
+
+#ifdef SPACE_TRACE
+
+#define TRACE_MAX_THREADS 80
+#define TRACE_MAX_DEPTH 32
+
+typedef struct {
+    const char* name;
+    uint64_t start;
+    uint64_t duration;
+} TraceEvent;
+
+// Only the owning thread writes to its ring; traceWrite reads it afterwards.
+typedef struct {
+    TraceEvent* events;
+    uint64_t written;
+    int id;
+    char name[32];
+    int depth;
+    const char* openName[TRACE_MAX_DEPTH];
+    uint64_t openStart[TRACE_MAX_DEPTH];
+} TraceThread;
+
+static TraceThread* threads[TRACE_MAX_THREADS];
+static int threadCount;
+static pthread_mutex_t threadsMutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread TraceThread* self;
+static __thread const char* pendingName;
+
+static bool recording;
+static uint64_t origin;
+
+static uint64_t nowNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Registers the calling thread on its first event. Returns NULL when the
+// thread table or the allocation is exhausted; that thread then records
+// nothing.
+static TraceThread* currentThread(void) {
+    if (self) {
+        return self;
+    }
+
+    TraceThread* t = calloc(1, sizeof(TraceThread));
+    TraceEvent* events = malloc(sizeof(TraceEvent) * TRACE_RING_SIZE);
+    if (!t || !events) {
+        free(t);
+        free(events);
+        return NULL;
+    }
+    t->events = events;
+
+    pthread_mutex_lock(&threadsMutex);
+    if (threadCount == TRACE_MAX_THREADS) {
+        pthread_mutex_unlock(&threadsMutex);
+        free(events);
+        free(t);
+        return NULL;
+    }
+    t->id = threadCount;
+    threads[threadCount++] = t;
+    pthread_mutex_unlock(&threadsMutex);
+
+    if (pendingName) {
+        snprintf(t->name, sizeof(t->name), "%s", pendingName);
+    } else {
+        snprintf(t->name, sizeof(t->name), "thread %d", t->id);
+    }
+    self = t;
+    return t;
+}
+
+void traceBegin(const char* name) {
+    if (!__atomic_load_n(&recording, __ATOMIC_RELAXED)) {
+        return;
+    }
+    TraceThread* t = currentThread();
+    if (!t) {
+        return;
+    }
+
+    // Zones deeper than the stack are dropped, but still counted so the
+    // matching traceEnd calls line up.
+    if (t->depth < TRACE_MAX_DEPTH) {
+        t->openName[t->depth] = name;
+        t->openStart[t->depth] = nowNanoseconds();
+    }
+    t->depth++;
+}
+
+void traceEnd(void) {
+    TraceThread* t = self;
+    // A zone opened before recording started has no entry; depth stays 0.
+    if (!t || t->depth == 0) {
+        return;
+    }
+
+    t->depth--;
+    if (t->depth < TRACE_MAX_DEPTH) {
+        TraceEvent* e = &t->events[t->written % TRACE_RING_SIZE];
+        e->name = t->openName[t->depth];
+        e->start = t->openStart[t->depth];
+        e->duration = nowNanoseconds() - e->start;
+        t->written++;
+    }
+}
+
+void traceSetThreadName(const char* name) {
+    if (self) {
+        snprintf(self->name, sizeof(self->name), "%s", name);
+    } else {
+        pendingName = name;
+    }
+}
+
+bool traceStart(void) {
+    origin = nowNanoseconds();
+    __atomic_store_n(&recording, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+void traceStop(void) {
+    __atomic_store_n(&recording, false, __ATOMIC_RELEASE);
+}
+
+bool traceWrite(const char* path, FILE* out) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Failed to open trace file %s\n", path);
+        return false;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    long total = 0;
+
+    pthread_mutex_lock(&threadsMutex);
+    for (int k = 0; k < threadCount; k++) {
+        TraceThread* t = threads[k];
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", t->id, t->name);
+        first = false;
+
+        uint64_t begin = t->written > TRACE_RING_SIZE ? t->written - TRACE_RING_SIZE : 0;
+        for (uint64_t n = begin; n < t->written; n++) {
+            const TraceEvent* e = &t->events[n % TRACE_RING_SIZE];
+            if (e->start < origin) {
+                continue;
+            }
+            fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    e->name, t->id, (double)(e->start - origin) / 1000.0, (double)e->duration / 1000.0);
+            total++;
+        }
+    }
+    pthread_mutex_unlock(&threadsMutex);
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    fprintf(out, "Wrote %ld trace events to %s\n", total, path);
+    return true;
+}
+
+#else
+
+void traceBegin(const char* name) {
+    (void)name;
+}
+
+void traceEnd(void) {
+}
+
+void traceSetThreadName(const char* name) {
+    (void)name;
+}
+
+bool traceStart(void) {
+    return false;
+}
+
+void traceStop(void) {
+}
+
+bool traceWrite(const char* path, FILE* out) {
+    (void)path;
+    (void)out;
+    return false;
+}
+
+#endif